@@ -23,6 +23,8 @@
 #include <QThread>
 #pragma warning (pop)
 
+#include <algorithm>
+
 // =======================================================================
 // function : Perform
 // purpose  :
@@ -44,47 +46,263 @@ Standard_Boolean JTData_WorkItem::Perform()
   return isLoaded;
 }
 
+// =======================================================================
+// function : pushEntry
+// purpose  :
+// =======================================================================
+void JTData_LoadingQueue::pushEntry (QueuedItem& theItem, const Standard_Transient* theKey)
+{
+  HeapEntry anEntry;
+  anEntry.Priority = theItem.Item.Priority();
+  anEntry.Stamp    = ++myStamp;
+  anEntry.Key      = theKey;
+
+  theItem.Stamp = anEntry.Stamp;
+
+  myHeap.push_back (anEntry);
+  std::push_heap (myHeap.begin(), myHeap.end());
+
+  // Re-prioritization leaves outdated entries in the heap
+  if (myHeap.size() > 2 * static_cast<size_t> (myItems.size()) + 64)
+  {
+    rebuildHeap();
+  }
+}
+
+// =======================================================================
+// function : rebuildHeap
+// purpose  :
+// =======================================================================
+void JTData_LoadingQueue::rebuildHeap()
+{
+  std::vector<HeapEntry> aHeap;
+  aHeap.reserve (myItems.size());
+
+  for (QHash<const Standard_Transient*, QueuedItem>::iterator anIter = myItems.begin(); anIter != myItems.end(); ++anIter)
+  {
+    HeapEntry anEntry;
+    anEntry.Priority = anIter->Item.Priority();
+    anEntry.Stamp    = anIter->Stamp;
+    anEntry.Key      = anIter.key();
+
+    aHeap.push_back (anEntry);
+  }
+
+  std::make_heap (aHeap.begin(), aHeap.end());
+
+  myHeap.swap (aHeap);
+}
+
 // =======================================================================
 // function : Enqueue
 // purpose  :
 // =======================================================================
-void JTData_LoadingQueue::Enqueue (const JTData_WorkItem& theQuery)
+Standard_Boolean JTData_LoadingQueue::Enqueue (const JTData_WorkItem& theQuery)
 {
+  const Standard_Transient* aKey = theQuery.LateLoaded().Access();
+
+  Standard_Boolean isAdded = Standard_False;
+
   myMutex.lock();
   {
-    myQueue.push_back (theQuery);
+    if (myIsStopped)
+    {
+      myMutex.unlock();
+      return Standard_False;
+    }
 
-    mySet.insert (theQuery.LateLoaded().Access());
+    if (myInProgress.contains (aKey))
+    {
+      myMutex.unlock();
+      return Standard_True;
+    }
 
-    myCondition.wakeOne();
+    QHash<const Standard_Transient*, QueuedItem>::iterator anIter = myItems.find (aKey);
+
+    if (anIter == myItems.end())
+    {
+      // Apply backpressure instead of growing the queue
+      if (myItems.size() >= myCapacity)
+      {
+        myMutex.unlock();
+        return Standard_False;
+      }
+
+      QueuedItem anItem;
+      anItem.Item  = theQuery;
+      anItem.Frame = myFrame;
+      anItem.Stamp = 0;
+
+      anIter = myItems.insert (aKey, anItem);
+
+      pushEntry (*anIter, aKey);
+
+      // Wake up idle loading thread
+      myCondition.wakeOne();
+
+      isAdded = Standard_True;
+    }
+    else
+    {
+      anIter->Frame = myFrame;
+
+      if (anIter->Item.Priority() != theQuery.Priority())
+      {
+        anIter->Item = theQuery;
+
+        pushEntry (*anIter, aKey);
+      }
+    }
   }
   myMutex.unlock();
 
-  emit workItemEnqueued();
+  if (isAdded)
+  {
+    emit workItemEnqueued();
+  }
+
+  return Standard_True;
 }
 
 // =======================================================================
 // function : Fetch
 // purpose  :
 // =======================================================================
-JTData_WorkItem JTData_LoadingQueue::Fetch()
+Standard_Boolean JTData_LoadingQueue::Fetch (JTData_WorkItem& theQuery)
+{
+  Standard_Boolean isFetched = Standard_False;
+
+  myMutex.lock();
+  {
+    while (!isFetched && !myIsStopped)
+    {
+      if (myHeap.empty())
+      {
+        myCondition.wait (&myMutex);
+        continue;
+      }
+
+      std::pop_heap (myHeap.begin(), myHeap.end());
+      HeapEntry anEntry = myHeap.back();
+      myHeap.pop_back();
+
+      // Skip entries of cancelled or re-prioritized work-items
+      QHash<const Standard_Transient*, QueuedItem>::iterator anIter = myItems.find (anEntry.Key);
+
+      if (anIter == myItems.end() || anIter->Stamp != anEntry.Stamp)
+      {
+        continue;
+      }
+
+      theQuery = anIter->Item;
+
+      myItems.erase (anIter);
+      myInProgress.insert (anEntry.Key);
+
+      isFetched = Standard_True;
+    }
+  }
+  myMutex.unlock();
+
+  return isFetched;
+}
+
+// =======================================================================
+// function : Finish
+// purpose  :
+// =======================================================================
+void JTData_LoadingQueue::Finish (const JTData_WorkItem& theQuery)
+{
+  myMutex.lock();
+  {
+    myInProgress.remove (theQuery.LateLoaded().Access());
+  }
+  myMutex.unlock();
+}
+
+// =======================================================================
+// function : BeginFrame
+// purpose  :
+// =======================================================================
+Standard_Integer JTData_LoadingQueue::BeginFrame()
 {
-  JTData_WorkItem aQuery;
+  Standard_Integer aBudget;
 
   myMutex.lock();
   {
-    while (myQueue.size() == 0)
+    Standard_Boolean isCancelled = Standard_False;
+
+    for (QHash<const Standard_Transient*, QueuedItem>::iterator anIter = myItems.begin(); anIter != myItems.end();)
+    {
+      if (anIter->Frame != myFrame)
+      {
+        anIter = myItems.erase (anIter);
+
+        isCancelled = Standard_True;
+      }
+      else
+      {
+        ++anIter;
+      }
+    }
+
+    if (isCancelled)
     {
-      myCondition.wait (&myMutex);
+      rebuildHeap();
     }
 
-    aQuery = myQueue.takeFirst();
+    ++myFrame;
 
-    mySet.remove (aQuery.LateLoaded().Access());
+    aBudget = myCapacity + myInProgress.size();
   }
   myMutex.unlock();
 
-  return aQuery;
+  return aBudget;
+}
+
+// =======================================================================
+// function : Clear
+// purpose  :
+// =======================================================================
+void JTData_LoadingQueue::Clear()
+{
+  myMutex.lock();
+  {
+    myItems.clear();
+    myHeap.clear();
+  }
+  myMutex.unlock();
+}
+
+// =======================================================================
+// function : Stop
+// purpose  :
+// =======================================================================
+void JTData_LoadingQueue::Stop()
+{
+  myMutex.lock();
+  {
+    myItems.clear();
+    myHeap.clear();
+
+    myIsStopped = Standard_True;
+
+    myCondition.wakeAll();
+  }
+  myMutex.unlock();
+}
+
+// =======================================================================
+// function : SetCapacity
+// purpose  :
+// =======================================================================
+void JTData_LoadingQueue::SetCapacity (const Standard_Integer theCapacity)
+{
+  myMutex.lock();
+  {
+    myCapacity = theCapacity;
+  }
+  myMutex.unlock();
 }
 
 // =======================================================================
@@ -97,7 +315,7 @@ Standard_Integer JTData_LoadingQueue::Size()
 
   myMutex.lock();
   {
-    aSize = myQueue.size();
+    aSize = myItems.size();
   }
   myMutex.unlock();
 
@@ -114,7 +332,9 @@ Standard_Boolean JTData_LoadingQueue::Enqueued (const JTData_WorkItem& theQuery)
 
   myMutex.lock();
   {
-    if (mySet.find (theQuery.LateLoaded().Access()) != mySet.end())
+    const Standard_Transient* aKey = theQuery.LateLoaded().Access();
+
+    if (myItems.contains (aKey) || myInProgress.contains (aKey))
     {
       anIsEnqueued = Standard_True;
     }
@@ -131,7 +351,7 @@ Standard_Boolean JTData_LoadingQueue::Enqueued (const JTData_WorkItem& theQuery)
 JTData_LoadingThread::JTData_LoadingThread (JTData_LoadingQueue& theQueue)
     : myQueue (theQueue)
 {
-  connect (&myQueue, SIGNAL (workItemEnqueued()), this, SLOT (Awake()));
+  //
 }
 
 // =======================================================================
@@ -140,8 +360,19 @@ JTData_LoadingThread::JTData_LoadingThread (JTData_LoadingQueue& theQueue)
 // =======================================================================
 void JTData_LoadingThread::run()
 {
-  while (myQueue.Size() > 0)
+  for (;;)
   {
-    myQueue.Fetch().Perform();
+    // Fresh work-item each time, as assignment connects its feedback again
+    JTData_WorkItem anItem;
+
+    // Waits for new work-items until the queue is stopped
+    if (!myQueue.Fetch (anItem))
+    {
+      break;
+    }
+
+    anItem.Perform();
+
+    myQueue.Finish (anItem);
   }
 }
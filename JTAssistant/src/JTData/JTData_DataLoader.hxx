@@ -19,6 +19,7 @@
 
 #pragma warning (push, 0)
 #include <QSet>
+#include <QHash>
 #include <QList>
 #include <QMutex>
 #include <QThread>
@@ -27,6 +28,8 @@
 
 #include <JtProperty_LateLoaded.hxx>
 
+#include <vector>
+
 
 //! Work-item to push into loading queue.
 class JTData_WorkItem : public QObject
@@ -38,7 +41,8 @@ public:
   //! Creates new work-item for loading triangulation data.
   JTData_WorkItem()
     : QObject (NULL),
-      myFeedback (NULL)
+      myFeedback (NULL),
+      myPriority (0.f)
   {
     //
   }
@@ -47,7 +51,8 @@ public:
   JTData_WorkItem (const JTData_WorkItem& theItem)
     : QObject (NULL),
       myLateLoaded (theItem.myLateLoaded),
-      myFeedback   (theItem.myFeedback)
+      myFeedback   (theItem.myFeedback),
+      myPriority   (theItem.myPriority)
   {
     if (myFeedback != NULL)
     {
@@ -56,10 +61,14 @@ public:
   }
 
   //! Creates new work-item for loading triangulation data.
-  JTData_WorkItem (const Handle(JtProperty_LateLoaded)& theLateLoaded, QObject* theFeedback)
+  //! Work-items with higher priority are loaded first.
+  JTData_WorkItem (const Handle(JtProperty_LateLoaded)& theLateLoaded,
+                   QObject*                             theFeedback,
+                   const Standard_ShortReal             thePriority = 0.f)
     : QObject (NULL),
       myLateLoaded (theLateLoaded),
-      myFeedback   (theFeedback)
+      myFeedback   (theFeedback),
+      myPriority   (thePriority)
   {
     if (myFeedback != NULL)
     {
@@ -72,6 +81,7 @@ public:
   {
     myLateLoaded = theItem.myLateLoaded;
     myFeedback   = theItem.myFeedback;
+    myPriority   = theItem.myPriority;
 
     if (myFeedback != NULL)
     {
@@ -87,6 +97,12 @@ public:
     return myLateLoaded;
   }
 
+  //! Returns loading priority of the work-item.
+  Standard_ShortReal Priority() const
+  {
+    return myPriority;
+  }
+
   //! Perform loading shape triangulation data from JT file.
   Standard_Boolean Perform();
 
@@ -105,19 +121,32 @@ protected:
 
   Handle(JtProperty_LateLoaded) myLateLoaded; //!< Shape node to load.
   QObject* myFeedback;                        //!< Pointer to scene for update feedback.
+  Standard_ShortReal myPriority;              //!< Loading priority (e.g. projected size).
 
 };
 
-//! Abstract command-queue for managing parallel threads.
+//! Priority command-queue shared by the loading threads.
+//! Work-items with higher priority are fetched first. Enqueueing an already
+//! queued work-item updates its priority, so the requester may re-prioritize
+//! the items each frame; the items not requested again during a frame are
+//! cancelled when the next frame begins. The queue is bounded: new work-items
+//! are rejected while it is full, so the requester should submit its requests
+//! in priority order within the budget returned by BeginFrame().
+//! Idle loading threads wait inside Fetch() until a work-item is enqueued
+//! or the queue is stopped.
 class JTData_LoadingQueue : public QObject
 {
   Q_OBJECT
 
 public:
 
-  //! Creates new loading queue.
-  JTData_LoadingQueue()
-   : QObject (NULL) {}
+  //! Creates new loading queue holding up to the given number of work-items.
+  JTData_LoadingQueue (const Standard_Integer theCapacity = 1024)
+   : QObject (NULL),
+     myFrame (0),
+     myStamp (0),
+     myCapacity (theCapacity),
+     myIsStopped (Standard_False) {}
 
   //! Releases resources of the loading queue.
   ~JTData_LoadingQueue() {}
@@ -127,37 +156,114 @@ public:
   //! Returns size of the loading queue.
   Standard_Integer Size();
 
-  //! Fetches work-item from the loading queue.
-  JTData_WorkItem Fetch();
+  //! Returns maximum number of queued work-items.
+  Standard_Integer Capacity() const
+  {
+    return myCapacity;
+  }
+
+  //! Sets maximum number of queued work-items.
+  void SetCapacity (const Standard_Integer theCapacity);
+
+  //! Fetches work-item with the highest priority from the loading queue.
+  //! Blocks while the queue is empty; returns false once the queue is stopped.
+  //! The fetched work-item should be marked as finished after performing it.
+  Standard_Boolean Fetch (JTData_WorkItem& theQuery);
+
+  //! Marks the fetched work-item as finished.
+  void Finish (const JTData_WorkItem& theQuery);
 
-  //! Enqueues new work-item onto loading queue.
-  void Enqueue (const JTData_WorkItem& theQuery);
+  //! Enqueues new work-item onto loading queue or updates the priority of the
+  //! queued one. Work-items being performed are not enqueued again.
+  //! Returns false if the new work-item is rejected as the queue is full.
+  Standard_Boolean Enqueue (const JTData_WorkItem& theQuery);
 
-  //! Checks if specific work-item is in loading queue.
+  //! Checks if specific work-item is in loading queue or being performed.
   Standard_Boolean Enqueued (const JTData_WorkItem& theQuery);
 
+  //! Begins new frame: cancels work-items not requested during the previous frame.
+  //! Returns request budget of the new frame: the number of pending (queued or
+  //! being performed) work-items the requester may keep.
+  Standard_Integer BeginFrame();
+
+  //! Cancels all queued work-items.
+  void Clear();
+
+  //! Cancels all queued work-items and releases the loading threads
+  //! waiting for new ones. Work-items are not accepted any more.
+  void Stop();
+
 signals:
 
+  //! Emitted when new work-item is added to the queue.
   void workItemEnqueued();
 
 protected:
 
-  //! Set of loading tasks.
-  QSet<const Standard_Transient*> mySet;
+  //! Queued loading task.
+  struct QueuedItem
+  {
+    JTData_WorkItem Item;  //!< Work-item to perform
+    quint64         Frame; //!< Last frame the work-item was requested in
+    quint64         Stamp; //!< Stamp of the heap entry with actual priority
+  };
+
+  //! Entry of the priority heap; entries with outdated stamps are skipped.
+  struct HeapEntry
+  {
+    Standard_ShortReal        Priority;
+    quint64                   Stamp;
+    const Standard_Transient* Key;
 
-  //! Queue of loading tasks.
-  QList<JTData_WorkItem> myQueue;
+    //! Orders entries by priority, then by enqueueing order.
+    bool operator< (const HeapEntry& theOther) const
+    {
+      return Priority < theOther.Priority
+         || (Priority == theOther.Priority && Stamp > theOther.Stamp);
+    }
+  };
+
+  //! Pushes new heap entry for the queued item.
+  void pushEntry (QueuedItem& theItem, const Standard_Transient* theKey);
+
+  //! Rebuilds the heap dropping outdated entries.
+  void rebuildHeap();
+
+protected:
+
+  //! Queued loading tasks.
+  QHash<const Standard_Transient*, QueuedItem> myItems;
+
+  //! Loading tasks being performed.
+  QSet<const Standard_Transient*> myInProgress;
+
+  //! Binary heap of loading tasks ordered by priority.
+  std::vector<HeapEntry> myHeap;
+
+  //! Current frame number.
+  quint64 myFrame;
+
+  //! Counter of heap entries.
+  quint64 myStamp;
+
+  //! Maximum number of queued work-items.
+  Standard_Integer myCapacity;
+
+  //! Indicates that the queue is stopped.
+  Standard_Boolean myIsStopped;
 
 protected:
 
   //! Manages access serialization of loading threads.
   QMutex myMutex;
 
-  //! Condition variable for synchronizing loading threads.
+  //! Signals idle loading threads of new work-items.
   QWaitCondition myCondition;
 };
 
 //! Separate thread for loading triangulation data.
+//! Several threads may serve the same loading queue. The thread performs
+//! queued work-items until the loading queue is stopped.
 class JTData_LoadingThread : public QThread
 {
   Q_OBJECT
@@ -167,17 +273,6 @@ public:
   //! Creates new thread for loading triangulation data.
   JTData_LoadingThread (JTData_LoadingQueue& theQueue);
 
-public slots:
-
-  //! Awakes the loader to process queued work items.
-  void Awake()
-  {
-    if (isRunning())
-      return;
-
-    start();
-  }
-
 protected:
 
   //! Executes loading thread.
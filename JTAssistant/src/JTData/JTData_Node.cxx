@@ -146,7 +146,9 @@ JTData_MeshNodeSource::JTData_MeshNodeSource (JTData_LoadingQueue& theQueue, con
 // function : RequestTriangulation
 // purpose  :
 // =======================================================================
-JTCommon_TriangleDataPtr JTData_MeshNodeSource::RequestTriangulation (const Standard_Integer theIndex, QObject* theFeedback)
+JTCommon_TriangleDataPtr JTData_MeshNodeSource::RequestTriangulation (const Standard_Integer   theIndex,
+                                                                       QObject*                 theFeedback,
+                                                                       const Standard_ShortReal thePriority)
 {
   if (myData.isNull())
   {
@@ -173,21 +175,34 @@ JTCommon_TriangleDataPtr JTData_MeshNodeSource::RequestTriangulation (const Stan
     }
     else
     {
-      if (myQueue.Size() < 1000) // fix overflow of the loading queue
-      {
-        JTData_WorkItem anItem (aLateLoaded[theIndex], theFeedback);
-
-        if (!myQueue.Enqueued (anItem))
-        {
-          myQueue.Enqueue (anItem);
-        }
-      }
+      // Rejected by the full queue, the request is repeated in later frames
+      myQueue.Enqueue (JTData_WorkItem (aLateLoaded[theIndex], theFeedback, thePriority));
     }
   }
 
   return myData;
 }
 
+// =======================================================================
+// function : TriangulationMemory
+// purpose  :
+// =======================================================================
+size_t JTData_MeshNodeSource::TriangulationMemory() const
+{
+  if (myData.isNull())
+  {
+    return 0;
+  }
+
+  const Handle(JtElement_ShapeLOD_TriStripSet)& aLOD = myData->Data;
+
+  return sizeof (float) * (aLOD->Vertices().Count()  * aLOD->Vertices().CompCount()
+                         + aLOD->Normals().Count()   * aLOD->Normals().CompCount()
+                         + aLOD->Colors().Count()    * aLOD->Colors().CompCount()
+                         + aLOD->TexCoords().Count() * aLOD->TexCoords().CompCount())
+       + sizeof (int) * aLOD->Indices().Count();
+}
+
 // =======================================================================
 // function : BuildTriangulation
 // purpose  :
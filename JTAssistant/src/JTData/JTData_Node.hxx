@@ -342,8 +342,12 @@ public:
 
 public:
 
-  //! Requests triangulation data for the mesh.
-  JTCommon_TriangleDataPtr RequestTriangulation (const Standard_Integer theIndex = 0, QObject* theFeedback = NULL);
+  //! Requests triangulation data for the mesh. If the data is not loaded yet,
+  //! enqueues its loading with the given priority (or updates the priority)
+  //! unless the loading queue is full.
+  JTCommon_TriangleDataPtr RequestTriangulation (const Standard_Integer   theIndex    = 0,
+                                                 QObject*                 theFeedback = NULL,
+                                                 const Standard_ShortReal thePriority = 0.f);
 
   //! Returns triangulation data for the mesh.
   JTCommon_TriangleDataPtr Triangulation()
@@ -357,6 +361,15 @@ public:
     return myTriangleCount;
   }
 
+  //! Returns size of the decoded triangulation data in bytes.
+  size_t TriangulationMemory() const;
+
+  //! Releases the decoded triangulation data; it will be loaded again on request.
+  void ReleaseTriangulation()
+  {
+    myData.reset();
+  }
+
 private:
 
   //! Reference to loading queue.
@@ -41,9 +41,15 @@ using namespace Eigen;
 // function : JTData_SceneGraph
 // purpose  :
 // =======================================================================
-JTData_SceneGraph::JTData_SceneGraph()
-  : myLoadingThread (myLoadingQueue)
+JTData_SceneGraph::JTData_SceneGraph (const Standard_Integer theNbLoaders)
 {
+  Standard_Integer aNbLoaders = theNbLoaders > 0 ? theNbLoaders : QThread::idealThreadCount();
+
+  for (Standard_Integer anIdx = 0; anIdx < qMax (aNbLoaders, 1); ++anIdx)
+  {
+    myLoadingThreads.push_back (new JTData_LoadingThread (myLoadingQueue));
+    myLoadingThreads.back()->start();
+  }
 }
 
 // =======================================================================
@@ -52,8 +58,15 @@ JTData_SceneGraph::JTData_SceneGraph()
 // =======================================================================
 JTData_SceneGraph::~JTData_SceneGraph()
 {
-  myLoadingThread.quit();
-  myLoadingThread.wait();
+  // Cancel queued tasks, release idle threads and wait for the tasks being performed
+  myLoadingQueue.Stop();
+
+  foreach (JTData_LoadingThread* aThread, myLoadingThreads)
+  {
+    aThread->wait();
+  }
+
+  qDeleteAll (myLoadingThreads);
 }
 
 // =======================================================================
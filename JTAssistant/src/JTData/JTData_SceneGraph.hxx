@@ -48,8 +48,9 @@ class JTData_SceneGraph
 {
 public:
 
-  //! Creates new empty scene graph.
-  JTData_SceneGraph();
+  //! Creates new empty scene graph with the given number of loading threads;
+  //! zero number means the number of processor cores.
+  JTData_SceneGraph (const Standard_Integer theNbLoaders = 0);
 
   //! Releases resources of scene graph.
   virtual ~JTData_SceneGraph();
@@ -77,6 +78,9 @@ public:
   //! Returns estimated memory consumption in bytes.
   virtual Standard_Integer EstimateMemoryUsed() const;
 
+  //! Returns command queue of data loading tasks.
+  JTData_LoadingQueue& LoadingQueue() { return myLoadingQueue; }
+
   //! Returns reference to object mapping nodes to TreeWidget items.
   const QMap<JTData_Node*, QTreeWidgetItem*>& NodeToItemMap() { return myNodeToItemMap; }
 
@@ -100,8 +104,8 @@ protected:
   //! Command queue to manage data loading tasks.
   JTData_LoadingQueue myLoadingQueue;
 
-  //! Separate thread for loading triangulation data.
-  JTData_LoadingThread myLoadingThread;
+  //! Separate threads for loading triangulation data.
+  QList<JTData_LoadingThread*> myLoadingThreads;
 
   //! RangeLod and Mesh nodes mapped to tree items.
   QMap<JTData_Node*, QTreeWidgetItem*> myNodeToItemMap;
@@ -132,7 +132,10 @@ JTGui_MainWindow::JTGui_MainWindow (QWidget *parent) :
   ui (new Ui::MainWindow),
   myIgnoreNextSelectionUpdate (false),
   isListeningItemChanges (true),
-  isRightMouseButtonUsed (false)
+  isRightMouseButtonUsed (false),
+  myGpuMemoryBudget (1024),
+  myCpuMemoryBudget (2048),
+  myUploadBudget (4096)
 {
   ui->setupUi (this);
   ui->tabWidget->setCurrentIndex(0);
@@ -270,6 +273,10 @@ void JTGui_MainWindow::saveSettings()
 
   aSettings.setValue ("settings/interact_key",    myKeyBindEdit->bindedKey());
   aSettings.setValue ("settings/selection_color", myCurrentSelectionColor);
+
+  aSettings.setValue ("settings/gpu_budget_mb", myGpuMemoryBudget);
+  aSettings.setValue ("settings/cpu_budget_mb", myCpuMemoryBudget);
+  aSettings.setValue ("settings/upload_budget_kb", myUploadBudget);
 }
 
 //=======================================================================
@@ -312,6 +319,10 @@ void JTGui_MainWindow::loadSettings()
 
   ui->myColorLabel->setStyleSheet (aLabelBgStyle.arg (myCurrentSelectionColor.name()));
 
+  myGpuMemoryBudget = aSettings.value ("settings/gpu_budget_mb", 1024).toInt();
+  myCpuMemoryBudget = aSettings.value ("settings/cpu_budget_mb", 2048).toInt();
+  myUploadBudget    = aSettings.value ("settings/upload_budget_kb", 4096).toInt();
+
   ui->mySelectionButtons->button (aSettings.value ("settings/selection_button", -2).toInt())->setChecked (true);
 
   if (aSettings.contains ("settings/rot_button"))
@@ -644,6 +655,9 @@ void JTGui_MainWindow::updateSettings()
   aSettings.IsStatsOsdVisible = ui->myOsdCheck->isChecked();
   aSettings.IsCameraAnimated = ui->myAnimateCheck->isChecked();
   aSettings.SelectionColor = myCurrentSelectionColor;
+  aSettings.GpuMemoryBudget = myGpuMemoryBudget;
+  aSettings.CpuMemoryBudget = myCpuMemoryBudget;
+  aSettings.UploadBudget = myUploadBudget;
 
   myRenderWindow->scene()->SetCameraMode (ui->actionEnablePerspective->isChecked() ? cmPerspective : cmOrthographic);
   myRenderWindow->needToUpdate();
@@ -740,12 +754,16 @@ void JTGui_MainWindow::updateStatusBar()
       100.f * (aStats.FullTriangleCount - aStats.VisibleTriangleCount) / aStats.FullTriangleCount;
 
 
-    ui->statusbar->showMessage (tr ("Visible triangles: %1    Culled triangles: %2    %3% Culled    %4 Vis parts    %5% Small-part usage")
+    ui->statusbar->showMessage (tr ("Visible triangles: %1    Culled triangles: %2    %3% Culled    %4 Vis parts    %5% Small-part usage    GPU: %6 MB    CPU: %7 MB    %8 Evicted    %9 Loading")
       .arg (aStats.VisibleTriangleCount)
       .arg (aStats.FullTriangleCount - aStats.VisibleTriangleCount)
       .arg ((int ) Round (aRatio))
       .arg (aStats.VisiblePartCount)
-      .arg (aStats.SmallPartBufferUsage));
+      .arg (aStats.SmallPartBufferUsage)
+      .arg (aStats.GpuMemoryUsed)
+      .arg (aStats.CpuMemoryUsed)
+      .arg (aStats.EvictionCount)
+      .arg (aStats.PendingRequests));
   }
   else
   {
@@ -263,6 +263,10 @@ private:
 
   QColor myCurrentSelectionColor;   //!< Cached color from selection color picker.
 
+  int myGpuMemoryBudget;            //!< Budget of GPU memory for part geometry (MB).
+  int myCpuMemoryBudget;            //!< Budget of CPU memory for decoded meshes (MB).
+  int myUploadBudget;               //!< Budget of geometry upload to GPU per frame (KB).
+
   JTCommon_CmdArgs myCmdArgs;       //!< Command line arguments.
 };
 
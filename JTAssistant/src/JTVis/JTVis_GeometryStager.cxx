@@ -0,0 +1,268 @@
+// JT format reading and visualization tools
+// Copyright (C) 2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include "JTVis_GeometryStager.hxx"
+
+#pragma warning (push, 0)
+#include <QMetaObject>
+#include <QRunnable>
+#pragma warning (pop)
+
+//! Task preparing GPU-ready data of a single mesh.
+class JTVis_StagingTask : public QRunnable
+{
+public:
+
+  JTVis_StagingTask (JTVis_GeometryStager* theStager,
+                     const JTVis_StagedMeshPtr& theMesh,
+                     const JTCommon_TriangleDataPtr& theTriangulation,
+                     int theGeneration)
+    : myStager (theStager),
+      myMesh (theMesh),
+      myTriangulation (theTriangulation),
+      myGeneration (theGeneration)
+  {
+    //
+  }
+
+  void run()
+  {
+    myMesh->Build (myTriangulation);
+
+    myStager->finish (myMesh, myGeneration);
+  }
+
+private:
+
+  JTVis_GeometryStager*    myStager;
+  JTVis_StagedMeshPtr      myMesh;
+  JTCommon_TriangleDataPtr myTriangulation;
+  int                      myGeneration;
+};
+
+// =======================================================================
+// function : Build
+// purpose  :
+// =======================================================================
+void JTVis_StagedMesh::Build (const JTCommon_TriangleDataPtr& theTriangulation)
+{
+  const Handle(JtElement_ShapeLOD_TriStripSet)& aLOD = theTriangulation->Data;
+
+  const int aVertexCount = aLOD->Vertices().Count();
+
+  const float* aPositions = aLOD->Vertices().Data();
+  const float* aNormals   = aLOD->Normals().Count() == aVertexCount ? aLOD->Normals().Data() : NULL;
+
+  Vertices.resize (aVertexCount * 6);
+
+  for (int anIdx = 0; anIdx < aVertexCount; ++anIdx)
+  {
+    float* aVertex = &Vertices[anIdx * 6];
+
+    aVertex[0] = aPositions[anIdx * 3 + 0];
+    aVertex[1] = aPositions[anIdx * 3 + 1];
+    aVertex[2] = aPositions[anIdx * 3 + 2];
+
+    aVertex[3] = aNormals != NULL ? aNormals[anIdx * 3 + 0] : 0.f;
+    aVertex[4] = aNormals != NULL ? aNormals[anIdx * 3 + 1] : 0.f;
+    aVertex[5] = aNormals != NULL ? aNormals[anIdx * 3 + 2] : 0.f;
+  }
+
+  Indices.assign (aLOD->Indices().Data(), aLOD->Indices().Data() + aLOD->Indices().Count());
+}
+
+// =======================================================================
+// function : JTVis_GeometryStager
+// purpose  :
+// =======================================================================
+JTVis_GeometryStager::JTVis_GeometryStager (QObject* theFeedback)
+  : myFeedback (theFeedback),
+    myPreparedSize (0),
+    myGeneration (0)
+{
+  myPool.setMaxThreadCount (2);
+}
+
+// =======================================================================
+// function : ~JTVis_GeometryStager
+// purpose  :
+// =======================================================================
+JTVis_GeometryStager::~JTVis_GeometryStager()
+{
+  myPool.clear();
+  myPool.waitForDone();
+}
+
+// =======================================================================
+// function : Stage
+// purpose  :
+// =======================================================================
+void JTVis_GeometryStager::Stage (JTData_MeshNodeSource* theSource,
+                                  const JTCommon_TriangleDataPtr& theTriangulation)
+{
+  int aGeneration;
+
+  myMutex.lock();
+  {
+    if (myStaging.contains (theSource))
+    {
+      myMutex.unlock();
+      return;
+    }
+
+    myStaging.insert (theSource);
+
+    aGeneration = myGeneration;
+  }
+  myMutex.unlock();
+
+  JTVis_StagedMeshPtr aMesh (new JTVis_StagedMesh);
+  aMesh->Source = theSource;
+
+  myPool.start (new JTVis_StagingTask (this, aMesh, theTriangulation, aGeneration));
+}
+
+// =======================================================================
+// function : finish
+// purpose  :
+// =======================================================================
+void JTVis_GeometryStager::finish (const JTVis_StagedMeshPtr& theMesh, int theGeneration)
+{
+  myMutex.lock();
+  {
+    if (theGeneration != myGeneration)
+    {
+      myMutex.unlock();
+      return;
+    }
+
+    myPrepared.append (theMesh);
+
+    myPreparedSize += theMesh->ByteSize();
+  }
+  myMutex.unlock();
+
+  QMetaObject::invokeMethod (myFeedback, "ForceUpdate", Qt::QueuedConnection);
+}
+
+// =======================================================================
+// function : IsStaging
+// purpose  :
+// =======================================================================
+bool JTVis_GeometryStager::IsStaging (JTData_MeshNodeSource* theSource)
+{
+  bool isStaging;
+
+  myMutex.lock();
+  {
+    isStaging = myStaging.contains (theSource);
+  }
+  myMutex.unlock();
+
+  return isStaging;
+}
+
+// =======================================================================
+// function : Take
+// purpose  :
+// =======================================================================
+void JTVis_GeometryStager::Take (size_t theBudget, std::vector<JTVis_StagedMeshPtr>& theMeshes)
+{
+  size_t aSize = 0;
+
+  myMutex.lock();
+  {
+    while (!myPrepared.isEmpty() && (theBudget == 0 || aSize < theBudget))
+    {
+      JTVis_StagedMeshPtr aMesh = myPrepared.takeFirst();
+
+      theMeshes.push_back (aMesh);
+
+      aSize += aMesh->ByteSize();
+
+      myPreparedSize -= aMesh->ByteSize();
+    }
+  }
+  myMutex.unlock();
+}
+
+// =======================================================================
+// function : Finish
+// purpose  :
+// =======================================================================
+void JTVis_GeometryStager::Finish (const JTVis_StagedMesh& theMesh)
+{
+  myMutex.lock();
+  {
+    myStaging.remove (theMesh.Source);
+  }
+  myMutex.unlock();
+}
+
+// =======================================================================
+// function : HasPrepared
+// purpose  :
+// =======================================================================
+bool JTVis_GeometryStager::HasPrepared()
+{
+  bool hasPrepared;
+
+  myMutex.lock();
+  {
+    hasPrepared = !myPrepared.isEmpty();
+  }
+  myMutex.unlock();
+
+  return hasPrepared;
+}
+
+// =======================================================================
+// function : PreparedSize
+// purpose  :
+// =======================================================================
+size_t JTVis_GeometryStager::PreparedSize()
+{
+  size_t aSize;
+
+  myMutex.lock();
+  {
+    aSize = myPreparedSize;
+  }
+  myMutex.unlock();
+
+  return aSize;
+}
+
+// =======================================================================
+// function : Clear
+// purpose  :
+// =======================================================================
+void JTVis_GeometryStager::Clear()
+{
+  myPool.clear();
+
+  myMutex.lock();
+  {
+    ++myGeneration;
+
+    myStaging.clear();
+    myPrepared.clear();
+
+    myPreparedSize = 0;
+  }
+  myMutex.unlock();
+}
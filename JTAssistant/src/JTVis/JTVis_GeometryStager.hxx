@@ -0,0 +1,124 @@
+// JT format reading and visualization tools
+// Copyright (C) 2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef JTVIS_GEOMETRYSTAGER_H
+#define JTVIS_GEOMETRYSTAGER_H
+
+#pragma warning (push, 0)
+#include <QSet>
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+#include <QSharedPointer>
+#pragma warning (pop)
+
+#include <JTData_Node.hxx>
+
+#include <vector>
+
+//! GPU-ready mesh data: interleaved positions and normals with indices.
+struct JTVis_StagedMesh
+{
+  JTData_MeshNodeSource* Source; //!< Mesh source the data is prepared for.
+
+  std::vector<float> Vertices; //!< Interleaved positions and normals (6 floats per vertex).
+  std::vector<int>   Indices;  //!< Triangle indices.
+
+  //! Returns size of the data to upload in bytes.
+  size_t ByteSize() const
+  {
+    return Vertices.size() * sizeof (float) + Indices.size() * sizeof (int);
+  }
+
+  //! Returns number of vertices.
+  int VertexCount() const
+  {
+    return static_cast<int> (Vertices.size() / 6);
+  }
+
+  //! Fills the data from the triangulation.
+  void Build (const JTCommon_TriangleDataPtr& theTriangulation);
+};
+
+typedef QSharedPointer<JTVis_StagedMesh> JTVis_StagedMeshPtr;
+
+//! Prepares GPU-ready mesh data on worker threads, so the GUI thread
+//! only uploads the prepared data in portions limited per frame.
+//! A mesh source stays marked as staged until its upload is finished.
+//! The feedback object is notified via queued ForceUpdate() call
+//! when the prepared data is available.
+class JTVis_GeometryStager
+{
+public:
+
+  //! Creates geometry stager.
+  JTVis_GeometryStager (QObject* theFeedback);
+
+  //! Waits for the staging tasks and releases the stager.
+  ~JTVis_GeometryStager();
+
+  //! Starts preparing the data for the mesh source.
+  //! Does nothing if the data is already being staged.
+  void Stage (JTData_MeshNodeSource* theSource,
+              const JTCommon_TriangleDataPtr& theTriangulation);
+
+  //! Checks if the data for the mesh source is being staged.
+  bool IsStaging (JTData_MeshNodeSource* theSource);
+
+  //! Takes the prepared meshes while their total size is below the given size
+  //! in bytes (zero size means no limit); the last mesh taken may exceed it
+  //! and should be uploaded by portions in the next frames.
+  void Take (size_t theBudget, std::vector<JTVis_StagedMeshPtr>& theMeshes);
+
+  //! Marks the taken mesh as uploaded (or dropped),
+  //! so that the data of its source may be staged again.
+  void Finish (const JTVis_StagedMesh& theMesh);
+
+  //! Returns true if prepared meshes are waiting for upload.
+  bool HasPrepared();
+
+  //! Returns size of the prepared meshes waiting for upload in bytes.
+  size_t PreparedSize();
+
+  //! Discards all staged data.
+  void Clear();
+
+protected:
+
+  //! Stores the prepared mesh unless it was discarded.
+  void finish (const JTVis_StagedMeshPtr& theMesh, int theGeneration);
+
+  friend class JTVis_StagingTask;
+
+protected:
+
+  QObject* myFeedback; //!< Object notified when prepared data is available.
+
+  QThreadPool myPool; //!< Worker threads preparing the data.
+
+  QSet<JTData_MeshNodeSource*> myStaging; //!< Mesh sources being staged.
+
+  QList<JTVis_StagedMeshPtr> myPrepared; //!< Prepared meshes waiting for upload.
+
+  size_t myPreparedSize; //!< Size of the prepared meshes in bytes.
+
+  int myGeneration; //!< Incremented to discard the data being staged.
+
+  QMutex myMutex; //!< Serializes access from worker threads.
+};
+
+#endif // JTVIS_GEOMETRYSTAGER_H
@@ -26,12 +26,13 @@ using namespace Eigen;
 JTVis_PartGeometry::JTVis_PartGeometry ()
   : myInitialized (false),
     myVertexBuffer (QOpenGLBuffer::VertexBuffer),
-    myNormalBuffer (QOpenGLBuffer::VertexBuffer),
     myIndexBuffer (QOpenGLBuffer::IndexBuffer),
     myIndicesCount (0),
     myAggregator (NULL),
     myStart (0),
-    myEnd (0)
+    myEnd (0),
+    myMemorySize (0),
+    myUploadedSize (0)
 {
   //
 }
@@ -40,59 +41,109 @@ JTVis_PartGeometry::JTVis_PartGeometry ()
 // function : InitializeGeometry
 // purpose  :
 //=======================================================================
-void JTVis_PartGeometry::InitializeGeometry (QOpenGLShaderProgram* theProgram,
-                                             const JTCommon_TriangleDataPtr& theTriangulation)
+bool JTVis_PartGeometry::InitializeGeometry (const JTVis_StagedMeshPtr& theMesh)
 {
+  // Buffers are only allocated here (glBufferData with no data),
+  // the data is written by portions (glBufferSubData) in UploadGeometry()
   myVertexBuffer.create();
   myVertexBuffer.setUsagePattern (QOpenGLBuffer::StaticDraw);
   if (!myVertexBuffer.bind())
   {
     qWarning() << "Could not bind vertex buffer to the context";
-    return;
+    return false;
   }
-  myVertexBuffer.allocate (theTriangulation->Data->Vertices().Data(),
-                           theTriangulation->Data->Vertices().Count() * 3 * sizeof (float));
+  myVertexBuffer.allocate (static_cast<int> (theMesh->Vertices.size() * sizeof (float)));
   myVertexBuffer.release();
 
-  myIndicesCount = theTriangulation->Data->Indices().Count();
-
-  myNormalBuffer.create();
-  myNormalBuffer.setUsagePattern (QOpenGLBuffer::StaticDraw);
-  if (!myNormalBuffer.bind())
-  {
-    qWarning() << "Could not bind normal buffer to the context";
-    return;
-  }
-  myNormalBuffer.allocate (theTriangulation->Data->Normals().Data(),
-                           theTriangulation->Data->Normals().Count() * 3 * sizeof (float));
-  myNormalBuffer.release();
+  myIndicesCount = static_cast<int> (theMesh->Indices.size());
 
   myIndexBuffer.create();
   myIndexBuffer.setUsagePattern (QOpenGLBuffer::StaticDraw);
   if (!myIndexBuffer.bind())
   {
     qWarning() << "Could not bind index buffer to the context";
-    return;
+    return false;
   }
-  myIndexBuffer.allocate (theTriangulation->Data->Indices().Data(),
-                          theTriangulation->Data->Indices().Count() * sizeof (int));
+  myIndexBuffer.allocate (static_cast<int> (myIndicesCount * sizeof (int)));
   myIndexBuffer.release();
 
-  myVao.create();
-  myVao.bind();
-  theProgram->bind();
+  myMemorySize   = theMesh->ByteSize();
+  myStagedMesh   = theMesh;
+  myUploadedSize = 0;
 
-  myVertexBuffer.bind();
-  theProgram->enableAttributeArray ("aPosition");
-  theProgram->setAttributeBuffer ("aPosition", GL_FLOAT, 0, 3);
+  return true;
+}
 
-  myNormalBuffer.bind();
-  theProgram->enableAttributeArray ("aNormal");
-  theProgram->setAttributeBuffer ("aNormal", GL_FLOAT, 0, 3);
+//=======================================================================
+// function : UploadGeometry
+// purpose  :
+//=======================================================================
+size_t JTVis_PartGeometry::UploadGeometry (QOpenGLShaderProgram* theProgram, size_t theBudget)
+{
+  if (myStagedMesh.isNull())
+    return 0;
 
-  myVao.release();
+  const size_t aVertexSize = myStagedMesh->Vertices.size() * sizeof (float);
+  const size_t aTotalSize  = myStagedMesh->ByteSize();
 
-  myInitialized = true;
+  // Portions consist of whole values (coordinates and indices are 4 bytes),
+  // so a budget below a single value still uploads one
+  size_t aPortion = aTotalSize - myUploadedSize;
+  if (theBudget != 0)
+  {
+    aPortion = qMin (aPortion, qMax (theBudget - theBudget % sizeof (float), sizeof (float)));
+  }
+
+  const size_t aStart = myUploadedSize;
+
+  // Vertex data is followed by indices in the upload order
+  if (aPortion > 0 && myUploadedSize < aVertexSize)
+  {
+    const size_t aSize = qMin (aPortion, aVertexSize - myUploadedSize);
+
+    myVertexBuffer.bind();
+    myVertexBuffer.write (static_cast<int> (myUploadedSize),
+                          reinterpret_cast<const char*> (myStagedMesh->Vertices.data()) + myUploadedSize,
+                          static_cast<int> (aSize));
+    myVertexBuffer.release();
+
+    myUploadedSize += aSize;
+    aPortion       -= aSize;
+  }
+
+  if (aPortion > 0)
+  {
+    const size_t anOffset = myUploadedSize - aVertexSize;
+
+    myIndexBuffer.bind();
+    myIndexBuffer.write (static_cast<int> (anOffset),
+                         reinterpret_cast<const char*> (myStagedMesh->Indices.data()) + anOffset,
+                         static_cast<int> (aPortion));
+    myIndexBuffer.release();
+
+    myUploadedSize += aPortion;
+  }
+
+  if (myUploadedSize == aTotalSize)
+  {
+    myVao.create();
+    myVao.bind();
+    theProgram->bind();
+
+    myVertexBuffer.bind();
+    theProgram->enableAttributeArray ("aPosition");
+    theProgram->setAttributeBuffer ("aPosition", GL_FLOAT, 0, 3, 6 * sizeof (float));
+    theProgram->enableAttributeArray ("aNormal");
+    theProgram->setAttributeBuffer ("aNormal", GL_FLOAT, 3 * sizeof (float), 3, 6 * sizeof (float));
+
+    myVao.release();
+
+    myStagedMesh.clear();
+
+    myInitialized = true;
+  }
+
+  return myUploadedSize - aStart;
 }
 
 //=======================================================================
@@ -109,6 +160,7 @@ void JTVis_PartGeometry::InitializeGeometry (OpenGLFunctions* theOGL,
   {
     myInitialized = true;
     myAggregator  = &theAggregator;
+    myMemorySize  = myIndicesCount * sizeof (int);
   }
 }
 
@@ -160,16 +212,24 @@ void JTVis_PartGeometry::Draw (OpenGLFunctions* theOGL, QOpenGLShaderProgram* th
 
   aVao.release();
 
-  QOpenGLBuffer& aVertBuffer = myAggregator == NULL ? myVertexBuffer : myAggregator->myVertexBuffer;
-  QOpenGLBuffer& aNormBuffer = myAggregator == NULL ? myNormalBuffer : myAggregator->myNormalBuffer;
-
-  aVertBuffer.bind();
-  theProgram->enableAttributeArray ("aPosition");
-  theProgram->setAttributeBuffer ("aPosition", GL_FLOAT, 0, 3);
+  if (myAggregator == NULL)
+  {
+    myVertexBuffer.bind();
+    theProgram->enableAttributeArray ("aPosition");
+    theProgram->setAttributeBuffer ("aPosition", GL_FLOAT, 0, 3, 6 * sizeof (float));
+    theProgram->enableAttributeArray ("aNormal");
+    theProgram->setAttributeBuffer ("aNormal", GL_FLOAT, 3 * sizeof (float), 3, 6 * sizeof (float));
+  }
+  else
+  {
+    myAggregator->myVertexBuffer.bind();
+    theProgram->enableAttributeArray ("aPosition");
+    theProgram->setAttributeBuffer ("aPosition", GL_FLOAT, 0, 3);
 
-  aNormBuffer.bind();
-  theProgram->enableAttributeArray ("aNormal");
-  theProgram->setAttributeBuffer ("aNormal", GL_FLOAT, 0, 3);
+    myAggregator->myNormalBuffer.bind();
+    theProgram->enableAttributeArray ("aNormal");
+    theProgram->setAttributeBuffer ("aNormal", GL_FLOAT, 0, 3);
+  }
 
   myIndexBuffer.bind();
   if (myAggregator == NULL)
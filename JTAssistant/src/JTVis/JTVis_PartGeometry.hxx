@@ -26,6 +26,7 @@
 #pragma warning (pop)
 
 #include "JTCommon_Utils.hxx"
+#include "JTVis_GeometryStager.hxx"
 
 #pragma warning (push, 0)
 #ifndef QT_OPENGL_ES_2
@@ -92,10 +93,25 @@ public:
   //! Creates PartGeometry object.
   JTVis_PartGeometry();
 
-  //! Initializes OpenGL buffer objects with data from the triangulation object.
-  //! Stores attribute bindings for given shader program in VAO.
-  void InitializeGeometry (QOpenGLShaderProgram* theProgram,
-                           const JTCommon_TriangleDataPtr& theTriangulation);
+  //! Allocates OpenGL buffer objects for GPU-ready data prepared by the stager;
+  //! the data is uploaded in portions by UploadGeometry().
+  //! Vertex attributes are stored in single interleaved buffer.
+  //! @return false if the buffers could not be created.
+  bool InitializeGeometry (const JTVis_StagedMeshPtr& theMesh);
+
+  //! Uploads next portion of the staged data not larger than the given size
+  //! in bytes (zero size means no limit), rounded down to whole 4-byte values
+  //! but at least one value. When all the data is uploaded,
+  //! stores attribute bindings for given shader program in VAO, releases
+  //! the staged data and the geometry becomes ready.
+  //! @return size of the uploaded portion in bytes.
+  size_t UploadGeometry (QOpenGLShaderProgram* theProgram, size_t theBudget);
+
+  //! Returns size of the staged data held until its upload is finished in bytes.
+  size_t StagedSize() const { return myStagedMesh.isNull() ? 0 : myStagedMesh->ByteSize(); }
+
+  //! Returns size of the staged data which is not uploaded yet in bytes.
+  size_t RemainingSize() const { return StagedSize() - (myStagedMesh.isNull() ? 0 : myUploadedSize); }
 
   //! Initializes OpenGL buffer objects with data from the triangulation object.
   //! Uses vertex attribute buffers of the part geometry aggregator instead of its own buffers.
@@ -121,12 +137,15 @@ public:
   //! Returns true if PartGeometry uses aggregator.
   bool UsesAggregator() { return myAggregator != NULL; }
 
+  //! Returns size of the OpenGL buffers owned by the geometry in bytes;
+  //! shared buffers of the aggregator are not included.
+  size_t MemorySize() const { return myMemorySize; }
+
 private:
   bool myInitialized; //!< Indicates when buffers already initialized.
 
   QOpenGLVertexArrayObject myVao; //!< OpenGL Vertex Array Object (VAO).
-  QOpenGLBuffer myVertexBuffer;   //!< Vertex buffer.
-  QOpenGLBuffer myNormalBuffer;   //!< Normal buffer.
+  QOpenGLBuffer myVertexBuffer;   //!< Interleaved vertex buffer (positions and normals).
   QOpenGLBuffer myIndexBuffer;    //!< Index buffer.
 
   int myIndicesCount; //!< Number of indices to draw.
@@ -136,6 +155,11 @@ private:
   int myStart; //!< Start vertex index (for glDrawRangeElements call).
   int myEnd;   //!< End vertex index (for glDrawRangeElements call).
 
+  size_t myMemorySize; //!< Size of the owned OpenGL buffers in bytes.
+
+  JTVis_StagedMeshPtr myStagedMesh; //!< Staged data being uploaded.
+  size_t              myUploadedSize; //!< Size of the staged data already uploaded in bytes.
+
 public:
 
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
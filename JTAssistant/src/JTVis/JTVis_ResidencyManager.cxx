@@ -0,0 +1,312 @@
+// JT format reading and visualization tools
+// Copyright (C) 2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include "JTVis_ResidencyManager.hxx"
+
+#include <algorithm>
+
+namespace
+{
+  //! Maximum number of entries examined per frame.
+  const size_t THE_SCAN_LIMIT = 2048;
+
+  //! Maximum number of evictions per frame.
+  const int THE_EVICTION_LIMIT = 256;
+
+  //! Relative cost of decoding a mesh compared to uploading it to GPU.
+  const float THE_DECODING_COST = 4.f;
+}
+
+// =======================================================================
+// function : JTVis_ResidencyManager
+// purpose  :
+// =======================================================================
+JTVis_ResidencyManager::JTVis_ResidencyManager()
+  : myGpuBudget (0),
+    myCpuBudget (0),
+    myGpuUsed (0),
+    myCpuUsed (0),
+    myStagedUsed (0),
+    myCursor (0),
+    myEvictionCount (0)
+{
+  //
+}
+
+// =======================================================================
+// function : SetBudgets
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::SetBudgets (size_t theGpuBudget, size_t theCpuBudget)
+{
+  myGpuBudget = theGpuBudget;
+  myCpuBudget = theCpuBudget;
+}
+
+// =======================================================================
+// function : Register
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::Register (JTData_MeshNodeSource* theSource,
+                                       size_t                 theGpuBytes,
+                                       size_t                 theCpuBytes,
+                                       bool                   isGpuPinned,
+                                       long long int          theFrame)
+{
+  QHash<JTData_MeshNodeSource*, int>::iterator anIter = myEntryIndex.find (theSource);
+
+  if (anIter == myEntryIndex.end())
+  {
+    Entry anEntry;
+    anEntry.Source      = theSource;
+    anEntry.GpuBytes    = 0;
+    anEntry.CpuBytes    = 0;
+    anEntry.IsGpuPinned = false;
+    anEntry.LastUse     = theFrame;
+    anEntry.ScreenSize  = 0.f;
+
+    anIter = myEntryIndex.insert (theSource, static_cast<int> (myEntries.size()));
+    myEntries.push_back (anEntry);
+  }
+
+  Entry& anEntry = myEntries[*anIter];
+
+  myGpuUsed = myGpuUsed - anEntry.GpuBytes + theGpuBytes;
+  myCpuUsed = myCpuUsed - anEntry.CpuBytes + theCpuBytes;
+
+  anEntry.GpuBytes    = theGpuBytes;
+  anEntry.CpuBytes    = theCpuBytes;
+  anEntry.IsGpuPinned = isGpuPinned;
+  anEntry.LastUse     = qMax (anEntry.LastUse, theFrame);
+}
+
+// =======================================================================
+// function : SetStagedMemory
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::SetStagedMemory (size_t theBytes)
+{
+  myStagedUsed = theBytes;
+}
+
+// =======================================================================
+// function : Touch
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::Touch (JTData_MeshNodeSource* theSource, long long int theFrame, float theScreenSize)
+{
+  QHash<JTData_MeshNodeSource*, int>::iterator anIter = myEntryIndex.find (theSource);
+
+  if (anIter == myEntryIndex.end())
+    return;
+
+  Entry& anEntry = myEntries[*anIter];
+
+  // Keep the largest size the data is used with during the frame (for instances);
+  // data registered for the next frame keeps that frame as the last use
+  if (anEntry.LastUse < theFrame)
+  {
+    anEntry.ScreenSize = theScreenSize;
+    anEntry.LastUse    = theFrame;
+  }
+  else
+  {
+    anEntry.ScreenSize = qMax (anEntry.ScreenSize, theScreenSize);
+  }
+}
+
+// =======================================================================
+// function : keepValue
+// purpose  :
+// =======================================================================
+float JTVis_ResidencyManager::keepValue (const Entry& theEntry, long long int theFrame, bool isGpu)
+{
+  const float anAge = static_cast<float> (qMax (theFrame - theEntry.LastUse, 1LL));
+
+  // Reloading GPU geometry without decoded mesh requires decoding as well
+  float aReloadCost = static_cast<float> (isGpu ? theEntry.GpuBytes : theEntry.CpuBytes) / (1 << 20);
+  if (!isGpu || theEntry.CpuBytes == 0)
+  {
+    aReloadCost *= THE_DECODING_COST;
+  }
+
+  return (theEntry.ScreenSize + 1e-3f) * (aReloadCost + 1e-2f) / anAge;
+}
+
+// =======================================================================
+// function : Evict
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::Evict (long long int theFrame, std::vector<JTData_MeshNodeSource*>& theGpuEvicted)
+{
+  bool isGpuExceeded = myGpuBudget != 0 && myGpuUsed > myGpuBudget;
+  bool isCpuExceeded = myCpuBudget != 0 && myCpuUsed + myStagedUsed > myCpuBudget;
+
+  if ((!isGpuExceeded && !isCpuExceeded) || myEntries.empty())
+    return;
+
+  // Collect candidates among the next portion of entries
+  std::vector<Candidate> aCandidates;
+
+  const size_t aScanCount = qMin (THE_SCAN_LIMIT, myEntries.size());
+
+  for (size_t aCount = 0; aCount < aScanCount; ++aCount)
+  {
+    myCursor = myCursor < myEntries.size() ? myCursor : 0;
+
+    const int anIndex = static_cast<int> (myCursor++);
+    const Entry& anEntry = myEntries[anIndex];
+
+    if (anEntry.LastUse >= theFrame)
+      continue;
+
+    if (isGpuExceeded && anEntry.GpuBytes != 0 && !anEntry.IsGpuPinned)
+    {
+      Candidate aCandidate = { keepValue (anEntry, theFrame, true), anIndex, true };
+      aCandidates.push_back (aCandidate);
+    }
+
+    if (isCpuExceeded && anEntry.CpuBytes != 0)
+    {
+      Candidate aCandidate = { keepValue (anEntry, theFrame, false), anIndex, false };
+      aCandidates.push_back (aCandidate);
+    }
+  }
+
+  std::sort (aCandidates.begin(), aCandidates.end());
+
+  // Evict the least valuable data until the budgets are met
+  std::vector<int> anEmptyEntries;
+  int anEvictionCount = 0;
+
+  for (size_t anIdx = 0; anIdx < aCandidates.size() && anEvictionCount < THE_EVICTION_LIMIT; ++anIdx)
+  {
+    const Candidate& aCandidate = aCandidates[anIdx];
+    Entry& anEntry = myEntries[aCandidate.Index];
+
+    if (aCandidate.IsGpu && isGpuExceeded)
+    {
+      myGpuUsed -= anEntry.GpuBytes;
+      anEntry.GpuBytes = 0;
+
+      theGpuEvicted.push_back (anEntry.Source);
+    }
+    else if (!aCandidate.IsGpu && isCpuExceeded)
+    {
+      anEntry.Source->ReleaseTriangulation();
+
+      myCpuUsed -= anEntry.CpuBytes;
+      anEntry.CpuBytes = 0;
+    }
+    else
+    {
+      continue;
+    }
+
+    ++anEvictionCount;
+
+    if (anEntry.GpuBytes == 0 && anEntry.CpuBytes == 0)
+    {
+      anEmptyEntries.push_back (aCandidate.Index);
+    }
+
+    isGpuExceeded = myGpuBudget != 0 && myGpuUsed > myGpuBudget;
+    isCpuExceeded = myCpuBudget != 0 && myCpuUsed + myStagedUsed > myCpuBudget;
+
+    if (!isGpuExceeded && !isCpuExceeded)
+      break;
+  }
+
+  myEvictionCount += anEvictionCount;
+
+  // Remove entries from the end to keep indices of the others valid
+  std::sort (anEmptyEntries.begin(), anEmptyEntries.end());
+
+  for (int anIdx = static_cast<int> (anEmptyEntries.size()) - 1; anIdx >= 0; --anIdx)
+  {
+    removeEntry (anEmptyEntries[anIdx]);
+  }
+}
+
+// =======================================================================
+// function : Release
+// purpose  :
+// =======================================================================
+bool JTVis_ResidencyManager::Release (JTData_MeshNodeSource* theSource, long long int theFrame)
+{
+  QHash<JTData_MeshNodeSource*, int>::iterator anIter = myEntryIndex.find (theSource);
+
+  if (anIter == myEntryIndex.end())
+    return false;
+
+  const int anIndex = *anIter;
+  Entry& anEntry = myEntries[anIndex];
+
+  if (anEntry.LastUse >= theFrame)
+    return false;
+
+  if (anEntry.CpuBytes != 0)
+  {
+    anEntry.Source->ReleaseTriangulation();
+
+    myCpuUsed -= anEntry.CpuBytes;
+    anEntry.CpuBytes = 0;
+  }
+
+  if (anEntry.IsGpuPinned)
+    return false;
+
+  const bool isGpuReleased = anEntry.GpuBytes != 0;
+
+  myGpuUsed -= anEntry.GpuBytes;
+
+  removeEntry (anIndex);
+
+  return isGpuReleased;
+}
+
+// =======================================================================
+// function : removeEntry
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::removeEntry (int theIndex)
+{
+  myEntryIndex.remove (myEntries[theIndex].Source);
+
+  if (theIndex != static_cast<int> (myEntries.size()) - 1)
+  {
+    myEntries[theIndex] = myEntries.back();
+    myEntryIndex[myEntries[theIndex].Source] = theIndex;
+  }
+
+  myEntries.pop_back();
+}
+
+// =======================================================================
+// function : Clear
+// purpose  :
+// =======================================================================
+void JTVis_ResidencyManager::Clear()
+{
+  myEntries.clear();
+  myEntryIndex.clear();
+
+  myGpuUsed    = 0;
+  myCpuUsed    = 0;
+  myStagedUsed = 0;
+  myCursor     = 0;
+}
@@ -0,0 +1,138 @@
+// JT format reading and visualization tools
+// Copyright (C) 2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef JTVIS_RESIDENCYMANAGER_H
+#define JTVIS_RESIDENCYMANAGER_H
+
+#pragma warning (push, 0)
+#include <QHash>
+#pragma warning (pop)
+
+#include <JTData_Node.hxx>
+
+#include <vector>
+
+//! Keeps memory used by part geometry within byte budgets.
+//!
+//! Tracks GPU buffers of part geometry and decoded CPU meshes of mesh node
+//! sources, counts host copies of geometry staged for upload against the CPU
+//! budget and, when a budget is exceeded, evicts the data having the least
+//! value to keep: the value grows with the screen size of the part and the
+//! cost of reloading the data, and falls with the time since the last use.
+//! Eviction is incremental: each frame only a bounded number of entries is
+//! examined and evicted. Data used in the current frame is never evicted.
+class JTVis_ResidencyManager
+{
+public:
+
+  //! Creates residency manager with unlimited budgets.
+  JTVis_ResidencyManager();
+
+  //! Sets memory budgets in bytes; zero budget means no limit.
+  void SetBudgets (size_t theGpuBudget, size_t theCpuBudget);
+
+  //! Registers memory used by GPU geometry (its evictable part) and decoded
+  //! CPU mesh of the given source. Pinned GPU geometry is never evicted.
+  //! The data counts as used in the given frame, so that it is not evicted
+  //! before it is drawn.
+  void Register (JTData_MeshNodeSource* theSource,
+                 size_t                 theGpuBytes,
+                 size_t                 theCpuBytes,
+                 bool                   isGpuPinned,
+                 long long int          theFrame);
+
+  //! Sets memory used by host copies of geometry staged for upload in bytes.
+  //! The copies are released by the upload, so they are not evicted, but
+  //! they are counted against the CPU budget.
+  void SetStagedMemory (size_t theBytes);
+
+  //! Marks data of the given source as used in the given frame.
+  void Touch (JTData_MeshNodeSource* theSource, long long int theFrame, float theScreenSize);
+
+  //! Evicts data exceeding the budgets. The decoded CPU meshes are released
+  //! directly, the sources losing GPU geometry are returned to the caller
+  //! which should release the geometry.
+  void Evict (long long int theFrame, std::vector<JTData_MeshNodeSource*>& theGpuEvicted);
+
+  //! Releases data of the given source unless it is used in the given frame.
+  //! The decoded CPU mesh is released directly; returns true if the caller
+  //! should release the GPU geometry (pinned geometry is kept).
+  bool Release (JTData_MeshNodeSource* theSource, long long int theFrame);
+
+  //! Forgets all the tracked data.
+  void Clear();
+
+  //! Returns memory used by tracked GPU geometry in bytes.
+  size_t GpuMemoryUsed() const { return myGpuUsed; }
+
+  //! Returns memory used by tracked decoded CPU meshes in bytes.
+  size_t CpuMemoryUsed() const { return myCpuUsed; }
+
+  //! Returns memory used by geometry staged for upload in bytes.
+  size_t StagedMemoryUsed() const { return myStagedUsed; }
+
+  //! Returns total number of evictions.
+  int EvictionCount() const { return myEvictionCount; }
+
+protected:
+
+  //! Tracked data of a mesh node source.
+  struct Entry
+  {
+    JTData_MeshNodeSource* Source;      //!< Mesh node source.
+    size_t                 GpuBytes;    //!< Size of GPU geometry.
+    size_t                 CpuBytes;    //!< Size of decoded CPU mesh.
+    bool                   IsGpuPinned; //!< GPU geometry may not be evicted.
+    long long int          LastUse;     //!< Last frame the data was used in.
+    float                  ScreenSize;  //!< Projected screen size at the last use.
+  };
+
+  //! Eviction candidate.
+  struct Candidate
+  {
+    float Value; //!< Value to keep the data.
+    int   Index; //!< Index of the entry.
+    bool  IsGpu; //!< Candidate is GPU geometry (otherwise CPU mesh).
+
+    bool operator< (const Candidate& theOther) const { return Value < theOther.Value; }
+  };
+
+  //! Returns value to keep the data of the entry.
+  static float keepValue (const Entry& theEntry, long long int theFrame, bool isGpu);
+
+  //! Removes entry which does not track any data anymore.
+  void removeEntry (int theIndex);
+
+protected:
+
+  std::vector<Entry> myEntries;                    //!< Tracked entries.
+  QHash<JTData_MeshNodeSource*, int> myEntryIndex; //!< Indices of entries of the sources.
+
+  size_t myGpuBudget; //!< GPU memory budget in bytes (0 for unlimited).
+  size_t myCpuBudget; //!< CPU memory budget in bytes (0 for unlimited).
+
+  size_t myGpuUsed;   //!< GPU memory used by tracked geometry.
+  size_t myCpuUsed;   //!< CPU memory used by tracked meshes.
+  size_t myStagedUsed; //!< CPU memory used by geometry staged for upload.
+
+  size_t myCursor;    //!< Position of the next entry to examine.
+
+  int myEvictionCount; //!< Total number of evictions.
+
+};
+
+#endif // JTVIS_RESIDENCYMANAGER_H
@@ -26,6 +26,7 @@
 #include <QOpenGLContext>
 #include <QVector3D>
 #include <QRectF>
+#include <QSet>
 #include <QStack>
 #include <QOpenGLTexture>
 
@@ -41,6 +42,7 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <algorithm>
 #include <typeinfo>
 
 using namespace Eigen;
@@ -67,8 +69,8 @@ JTVis_Scene::JTVis_Scene (QObject* parent)
     myMousePos (0, 0),
     myViewport (0, 0),
     myCurrentState (0),
-    myUnloadCheckPeriod (500),
-    myOldFrameCount (1000),
+    myGeometryStager (this),
+    myUploadedBytes (0),
     mySelectionFbo (NULL),
     myScreenshotFbo (NULL),
     isPerformingSelection (false),
@@ -203,10 +205,9 @@ void JTVis_Scene::Update (float theTime)
   if (myGeometrySource.isNull())
     return;
 
-  if (myCurrentState % myUnloadCheckPeriod == 0)
-  {
-    WalkScenegraph (JTVis_ScenegraphTaskPtr (new JTVis_UnloadOldTask (this, myGeometrySource->SceneGraph()->Tree())));
-  }
+  EvictGeometry();
+
+  UploadStagedGeometry();
 
   ++myCurrentState;
 
@@ -388,6 +389,14 @@ void JTVis_Scene::Render()
 
   float anInvCameraScale = 1.f / myCamera->Scale();
 
+  // Cancel loading of the parts not requested during the previous frame
+  const int aRequestBudget = myGeometrySource->SceneGraph()->LoadingQueue().BeginFrame();
+
+  myLoadingRequests.clear();
+
+  // Parts of the LOD representations being loaded are requested, but not drawn yet
+  myLoadingRequests.insert (myLoadingRequests.end(), myLodRequests.begin(), myLodRequests.end());
+
   for (size_t aNodeIdx = 0; aNodeIdx < anElementList.Elements.size(); ++aNodeIdx)
   {
     int aNode = anElementList.Elements.at (aNodeIdx);
@@ -424,7 +433,8 @@ void JTVis_Scene::Render()
           aLastVaoUsed = 0xffffff;
         }
 
-        RequestGeometryForNode (aPartNode);
+        LoadingRequest aRequest = { LoadingPriority (aCurrentBox), aPartNode };
+        myLoadingRequests.push_back (aRequest);
       }
       else
       {
@@ -442,6 +452,8 @@ void JTVis_Scene::Render()
           }
         }
 
+        myResidencyManager.Touch (aPartNode->MeshNode->Source().data(), myCurrentState, LoadingPriority (aCurrentBox));
+
         myStats.VisiblePartCount += 1;
 
         Matrix4f anMvpMatrix = aViewProjectionMatrix * aPartNode->Transform();
@@ -484,6 +496,8 @@ void JTVis_Scene::Render()
     }
   }
 
+  ServeLoadingRequests (aRequestBudget);
+
   if (aLastVaoUsed != 0xffffff)
   {
     static QVertexArrayObjectHelper aHelper (myContext);
@@ -744,33 +758,57 @@ void JTVis_Scene::PerformSelection (int theNodeId, bool isMultipleSelection)
 // function : RequestGeometryForNode
 // purpose  :
 // =======================================================================
-void JTVis_Scene::RequestGeometryForNode (JTVis_PartNode* theNode)
+void JTVis_Scene::RequestGeometryForNode (JTVis_PartNode* theNode, const float thePriority)
 {
-  QMap<JTData_MeshNodeSource*, JTVis_PartGeometryPtr>::iterator anIter = myInstancedMeshes.find (theNode->MeshNode->Source().data());
+  JTData_MeshNodeSource* aSource = theNode->MeshNode->Source().data();
+
+  QMap<JTData_MeshNodeSource*, JTVis_PartGeometryPtr>::iterator anIter = myInstancedMeshes.find (aSource);
 
   if (anIter == myInstancedMeshes.end())
   {
-    JTCommon_TriangleDataPtr aData = theNode->MeshNode->Source()->RequestTriangulation (0, this);
+    JTCommon_TriangleDataPtr aData = aSource->RequestTriangulation (0, this, thePriority);
 
     if (!aData.isNull() && aData->Data->Vertices().Count()  != 0)
     {
-      JTVis_PartGeometryPtr aNewPart = JTVis_PartGeometryPtr (new JTVis_PartGeometry());
+      const bool isSmall = aData->Data->Indices().Count() / 3 <= mySmallPartTreshold;
+
+      const size_t aBudget = static_cast<size_t> (qMax (mySettings.UploadBudget, 0)) << 10;
 
-      if (aData->Data->Indices().Count() / 3 > mySmallPartTreshold)
+      bool toStage = !isSmall;
+
+      // Small geometry is put to the aggregator directly while the upload budget allows
+      if (isSmall && (aBudget == 0 || myUploadedBytes < aBudget))
       {
-        aNewPart->InitializeGeometry (myShaderProgram, aData);
+        JTVis_PartGeometryPtr aNewPart = JTVis_PartGeometryPtr (new JTVis_PartGeometry());
+
+        aNewPart->InitializeGeometry (this, aData, myPartAggregator);
+
+        if (aNewPart->IsReady())
+        {
+          myUploadedBytes += aData->Data->Vertices().Count() * 6 * sizeof (float) + aNewPart->MemorySize();
+
+          AddPartGeometry (aSource, aNewPart);
+
+          theNode->SetGeometry (aNewPart);
+          theNode->TriangleCount = aNewPart->TriangleCount();
+
+          return;
+        }
+
+        // The aggregator is full
+        toStage = true;
       }
-      else
+      else if (isSmall)
       {
-        aNewPart->InitializeGeometry (this, aData, myPartAggregator);
-        if (aNewPart->IsReady() == false)
-          aNewPart->InitializeGeometry (myShaderProgram, aData);
+        // Retry in the next frame
+        emit RequestViewUpdate();
       }
 
-      theNode->SetGeometry (aNewPart);
-      myInstancedMeshes.insert (theNode->MeshNode->Source().data(), aNewPart);
-
-      theNode->TriangleCount = aNewPart->TriangleCount();
+      // Other geometry is uploaded in portions once prepared by worker threads
+      if (toStage)
+      {
+        myGeometryStager.Stage (aSource, aData);
+      }
     }
   }
   else
@@ -780,6 +818,235 @@ void JTVis_Scene::RequestGeometryForNode (JTVis_PartNode* theNode)
   }
 }
 
+// =======================================================================
+// function : UploadStagedGeometry
+// purpose  :
+// =======================================================================
+void JTVis_Scene::UploadStagedGeometry()
+{
+  myUploadedBytes = 0;
+
+  const size_t aBudget = static_cast<size_t> (qMax (mySettings.UploadBudget, 0)) << 10;
+
+  // Take new meshes only if the uploads in progress leave some budget
+  size_t aPendingSize = 0;
+
+  for (int anIdx = 0; anIdx < myPendingUploads.size(); ++anIdx)
+  {
+    aPendingSize += myPendingUploads[anIdx].Geometry->RemainingSize();
+  }
+
+  std::vector<JTVis_StagedMeshPtr> aMeshes;
+
+  if (aBudget == 0 || aPendingSize < aBudget)
+  {
+    myGeometryStager.Take (aBudget == 0 ? 0 : aBudget - aPendingSize, aMeshes);
+  }
+
+  for (size_t anIdx = 0; anIdx < aMeshes.size(); ++anIdx)
+  {
+    // Skip the data of a source which got its geometry meanwhile
+    if (myInstancedMeshes.contains (aMeshes[anIdx]->Source))
+    {
+      myGeometryStager.Finish (*aMeshes[anIdx]);
+      continue;
+    }
+
+    // Buffers are allocated at once, the data is written by portions below
+    PendingUpload anUpload;
+    anUpload.Mesh     = aMeshes[anIdx];
+    anUpload.Geometry = JTVis_PartGeometryPtr (new JTVis_PartGeometry());
+
+    if (!anUpload.Geometry->InitializeGeometry (anUpload.Mesh))
+    {
+      myGeometryStager.Finish (*anUpload.Mesh);
+      continue;
+    }
+
+    myPendingUploads.append (anUpload);
+  }
+
+  // Upload the data in order, a large mesh is spread over several frames
+  while (!myPendingUploads.isEmpty() && (aBudget == 0 || myUploadedBytes < aBudget))
+  {
+    const PendingUpload& anUpload = myPendingUploads.first();
+
+    // Drop the data of a source which got its geometry while it is being uploaded
+    if (!myInstancedMeshes.contains (anUpload.Mesh->Source))
+    {
+      myUploadedBytes += anUpload.Geometry->UploadGeometry (myShaderProgram, aBudget == 0 ? 0 : aBudget - myUploadedBytes);
+
+      if (!anUpload.Geometry->IsReady())
+      {
+        break;
+      }
+
+      AddPartGeometry (anUpload.Mesh->Source, anUpload.Geometry);
+    }
+
+    myGeometryStager.Finish (*anUpload.Mesh);
+
+    myPendingUploads.removeFirst();
+  }
+
+  // Instances take the new geometry when drawn in the next frame
+  if (myUploadedBytes != 0 || !myPendingUploads.isEmpty() || myGeometryStager.HasPrepared())
+  {
+    emit RequestViewUpdate();
+  }
+}
+
+// =======================================================================
+// function : AddPartGeometry
+// purpose  :
+// =======================================================================
+void JTVis_Scene::AddPartGeometry (JTData_MeshNodeSource* theSource, const JTVis_PartGeometryPtr& theGeometry)
+{
+  // New geometry is drawn in the next frame at the latest, keep it until then
+  myResidencyManager.Register (theSource, theGeometry->MemorySize(), theSource->TriangulationMemory(),
+                               theGeometry->UsesAggregator(), myCurrentState + 1);
+
+  myInstancedMeshes.insert (theSource, theGeometry);
+}
+
+// =======================================================================
+// function : ServeLoadingRequests
+// purpose  :
+// =======================================================================
+void JTVis_Scene::ServeLoadingRequests (const int theBudget)
+{
+  // Stable order keeps the requests deterministic for equal priorities
+  std::stable_sort (myLoadingRequests.begin(), myLoadingRequests.end());
+
+  myStats.PendingRequests  = 0;
+  myStats.DeferredRequests = 0;
+
+  bool isGeometryChanged = false;
+
+  for (size_t anIdx = 0; anIdx < myLoadingRequests.size(); ++anIdx)
+  {
+    JTVis_PartNode* aPartNode = myLoadingRequests[anIdx].PartNode;
+
+    JTData_MeshNodeSource* aSource = aPartNode->MeshNode->Source().data();
+
+    // Geometry already available in memory is taken regardless of the budget;
+    // requests beyond the budget are not repeated, so their queued loading is
+    // cancelled in favor of the more important ones
+    const bool isAvailable = !aSource->Triangulation().isNull() || myInstancedMeshes.contains (aSource);
+
+    if (!isAvailable && myStats.PendingRequests >= theBudget)
+    {
+      ++myStats.DeferredRequests;
+      continue;
+    }
+
+    JTVis_PartGeometry* aPrevGeometry = aPartNode->Geometry().data();
+
+    RequestGeometryForNode (aPartNode, myLoadingRequests[anIdx].Priority);
+
+    if (aPartNode->Geometry().data() != aPrevGeometry)
+    {
+      isGeometryChanged = true;
+    }
+
+    // Parts waiting for the upload of available geometry take no queue slot
+    if (!isAvailable && !aPartNode->IsReady())
+    {
+      ++myStats.PendingRequests;
+    }
+  }
+
+  // Draw the geometry taken from memory in the next frame
+  if (isGeometryChanged)
+  {
+    emit RequestViewUpdate();
+  }
+}
+
+// =======================================================================
+// function : EvictGeometry
+// purpose  :
+// =======================================================================
+void JTVis_Scene::EvictGeometry()
+{
+  myResidencyManager.SetBudgets (static_cast<size_t> (qMax (mySettings.GpuMemoryBudget, 0)) << 20,
+                                 static_cast<size_t> (qMax (mySettings.CpuMemoryBudget, 0)) << 20);
+
+  // Host copies of the staged geometry are released by the upload only
+  size_t aStagedSize = myGeometryStager.PreparedSize();
+
+  for (int anIdx = 0; anIdx < myPendingUploads.size(); ++anIdx)
+  {
+    aStagedSize += myPendingUploads[anIdx].Geometry->StagedSize();
+  }
+
+  myResidencyManager.SetStagedMemory (aStagedSize);
+
+  QSet<JTData_MeshNodeSource*> aReleased;
+
+  // Coarse LOD representations replaced during the last frame are not kept
+  // unless they were drawn elsewhere
+  for (size_t anIdx = 0; anIdx < myReplacedLods.size(); ++anIdx)
+  {
+    if (myResidencyManager.Release (myReplacedLods[anIdx], myCurrentState))
+    {
+      aReleased.insert (myReplacedLods[anIdx]);
+    }
+  }
+
+  myReplacedLods.clear();
+
+  std::vector<JTData_MeshNodeSource*> anEvicted;
+  myResidencyManager.Evict (myCurrentState, anEvicted);
+
+  for (size_t anIdx = 0; anIdx < anEvicted.size(); ++anIdx)
+  {
+    aReleased.insert (anEvicted[anIdx]);
+  }
+
+  if (!aReleased.isEmpty())
+  {
+    foreach (JTData_MeshNodeSource* aSource, aReleased)
+    {
+      myInstancedMeshes.remove (aSource);
+    }
+
+    // Release the geometry by dropping all references to it
+    for (size_t anIdx = 0; anIdx < myPartNodes.size(); ++anIdx)
+    {
+      JTVis_PartNode* aPartNode = myPartNodes[anIdx].data();
+
+      if (aPartNode->IsReady() && aReleased.contains (aPartNode->MeshNode->Source().data()))
+      {
+        aPartNode->Clear();
+      }
+    }
+  }
+
+  myStats.GpuMemoryUsed = static_cast<int> (myResidencyManager.GpuMemoryUsed() >> 20);
+  myStats.CpuMemoryUsed = static_cast<int> ((myResidencyManager.CpuMemoryUsed() + myResidencyManager.StagedMemoryUsed()) >> 20);
+  myStats.EvictionCount = myResidencyManager.EvictionCount();
+}
+
+// =======================================================================
+// function : LoadingPriority
+// purpose  :
+// =======================================================================
+float JTVis_Scene::LoadingPriority (const JTCommon_AABB& theBox)
+{
+  if (myCamera->IsOrthographic())
+  {
+    return theBox.Size().norm() / myCamera->Scale();
+  }
+
+  Vector3f aBoxCenter (theBox.Center().x(), theBox.Center().y(), theBox.Center().z());
+
+  const float aFrustumWidth = (myCamera->EyePosition() - aBoxCenter).norm() *
+    tanf (myCamera->FieldOfView() * 0.5f / 180.f * static_cast<float> (M_PI)) * 2.f;
+
+  return theBox.Size().norm() / qMax (aFrustumWidth, 1e-6f);
+}
+
 // =======================================================================
 // function : ResetFbos
 // purpose  :
@@ -976,6 +1243,8 @@ void JTVis_Scene::UpdateLods()
 
   myVisibleBounds.Clear();
 
+  myLodRequests.clear();
+
   const float aPixelSize = qMax (1.f / myViewport.x(), 1.f / myViewport.y());
   const float aBaseSize  = aPixelSize * 350.f;
 
@@ -1047,7 +1316,22 @@ void JTVis_Scene::UpdateLods()
         }
       }
 
-      aStack.push (aRangeLOD->Children.at (aRangeLOD->Children.size() - 1 - aSelectedLod).data());
+      JTData_Node* aSelectedChild = aRangeLOD->Children.at (aRangeLOD->Children.size() - 1 - aSelectedLod).data();
+      JTData_Node* aCoarsestChild = aRangeLOD->Children.back().data();
+
+      if (aSelectedChild != aCoarsestChild && !RequestLodGeometry (aSelectedChild))
+      {
+        // Draw the coarsest representation until the selected one is uploaded
+        myCoarseLods.insert (aRangeLOD);
+
+        aSelectedChild = aCoarsestChild;
+      }
+      else if (myCoarseLods.remove (aRangeLOD) && aSelectedChild != aCoarsestChild)
+      {
+        CollectMeshSources (aCoarsestChild, myReplacedLods);
+      }
+
+      aStack.push (aSelectedChild);
     }
     else
     {
@@ -1063,6 +1347,108 @@ void JTVis_Scene::UpdateLods()
   myStats.FullTriangleCount = aTriangleCounter;
 }
 
+// =======================================================================
+// function : RequestLodGeometry
+// purpose  :
+// =======================================================================
+bool JTVis_Scene::RequestLodGeometry (JTData_Node* theNode)
+{
+  bool isUploaded = true;
+
+  QStack<JTData_Node*> aStack;
+
+  aStack.push (theNode);
+
+  while (!aStack.isEmpty())
+  {
+    JTData_Node* aNode = aStack.pop();
+
+    if (!aNode->IsVisible())
+      continue;
+
+    if (typeid (*aNode) == typeid (JTData_MeshNode))
+    {
+      JTData_MeshNode* aMesh = static_cast<JTData_MeshNode*> (aNode);
+
+      JTVis_PartNodePtr aPartNode = myMeshToPartMap.value (aMesh);
+      if (aPartNode.isNull())
+        continue;
+
+      JTData_MeshNodeSource* aSource = aMesh->Source().data();
+
+      // Keep the uploaded parts until the whole representation is drawn
+      if (myInstancedMeshes.contains (aSource))
+      {
+        myResidencyManager.Touch (aSource, myCurrentState, LoadingPriority (aPartNode->Bounds));
+
+        // Instances take the uploaded geometry before they are drawn
+        if (!aPartNode->IsReady())
+        {
+          RequestGeometryForNode (aPartNode.data());
+        }
+      }
+      else
+      {
+        LoadingRequest aRequest = { LoadingPriority (aPartNode->Bounds), aPartNode.data() };
+        myLodRequests.push_back (aRequest);
+
+        isUploaded = false;
+      }
+    }
+    else if (typeid (*aNode) == typeid (JTData_RangeLODNode))
+    {
+      JTData_RangeLODNode* aRangeLOD = static_cast<JTData_RangeLODNode*> (aNode);
+
+      // Nested LODs are refined progressively as well, starting from the coarsest one
+      if (!aRangeLOD->Children.empty())
+      {
+        aStack.push (aRangeLOD->Children.back().data());
+      }
+    }
+    else
+    {
+      JTData_GroupNode* aGroup = static_cast<JTData_GroupNode*> (aNode);
+
+      for (size_t anIdx = 0; anIdx < aGroup->Children.size(); ++anIdx)
+      {
+        aStack.push (aGroup->Children.at (anIdx).data());
+      }
+    }
+  }
+
+  return isUploaded;
+}
+
+// =======================================================================
+// function : CollectMeshSources
+// purpose  :
+// =======================================================================
+void JTVis_Scene::CollectMeshSources (JTData_Node* theNode, std::vector<JTData_MeshNodeSource*>& theSources)
+{
+  QStack<JTData_Node*> aStack;
+
+  aStack.push (theNode);
+
+  while (!aStack.isEmpty())
+  {
+    JTData_Node* aNode = aStack.pop();
+
+    if (typeid (*aNode) == typeid (JTData_MeshNode))
+    {
+      theSources.push_back (static_cast<JTData_MeshNode*> (aNode)->Source().data());
+    }
+    else
+    {
+      JTData_GroupNode* aGroup = static_cast<JTData_GroupNode*> (aNode);
+
+      for (size_t anIdx = 0; anIdx < aGroup->Children.size(); ++anIdx)
+      {
+        aStack.push (aGroup->Children.at (anIdx).data());
+      }
+    }
+  }
+}
+
 // =======================================================================
 // function : WalkScenegraph
 // purpose  :
@@ -1107,6 +1493,12 @@ void JTVis_Scene::PreparePartNodes()
 
   myPartNodes.clear();
   myBvhGeometry.Clear();
+  myResidencyManager.Clear();
+  myGeometryStager.Clear();
+  myPendingUploads.clear();
+  myLodRequests.clear();
+  myCoarseLods.clear();
+  myReplacedLods.clear();
 
   WalkScenegraph (JTVis_ScenegraphTaskPtr (new JTVis_PrepareNodeTask(this, aSceneGraph->Tree())));
 
@@ -20,6 +20,7 @@
 #pragma warning (push, 0)
 #include <QMatrix4x4>
 #include <QStringList>
+#include <QSet>
 #include <QtGui/QVector2D>
 
 #include <QOpenGLBuffer>
@@ -60,8 +61,11 @@
 
 #include "JTVis_TargetedCamera.hxx"
 #include "JTVis_CameraTransition.hxx"
+#include "JTVis_ResidencyManager.hxx"
+#include "JTVis_GeometryStager.hxx"
 
 #include <set>
+#include <vector>
 
 //! Statistical data of visualization process.
 struct JTVis_Stats
@@ -71,13 +75,23 @@ struct JTVis_Stats
                int theSizeCulledTriangles  = 0,
                int thePartCount            = 0,
                int theVisiblePartCount     = 0,
-               int theSmallPartBufferUsage = 0)
+               int theSmallPartBufferUsage = 0,
+               int theGpuMemoryUsed        = 0,
+               int theCpuMemoryUsed        = 0,
+               int theEvictionCount        = 0,
+               int thePendingRequests      = 0,
+               int theDeferredRequests     = 0)
   : VisibleTriangleCount (theVisibleTriangleCount),
     FullTriangleCount    (theFullTriangleCount),
     SizeCulledTriangles  (theSizeCulledTriangles),
     PartCount            (thePartCount),
     VisiblePartCount     (theVisiblePartCount),
-    SmallPartBufferUsage (theSmallPartBufferUsage)
+    SmallPartBufferUsage (theSmallPartBufferUsage),
+    GpuMemoryUsed        (theGpuMemoryUsed),
+    CpuMemoryUsed        (theCpuMemoryUsed),
+    EvictionCount        (theEvictionCount),
+    PendingRequests      (thePendingRequests),
+    DeferredRequests     (theDeferredRequests)
   {}
 
   int VisibleTriangleCount; //!< Count of visible triangles.
@@ -88,6 +102,13 @@ struct JTVis_Stats
   int VisiblePartCount;     //!< Count of visible parts.
 
   int SmallPartBufferUsage; //!< Utilization of scene SmallPartBuffer.
+
+  int GpuMemoryUsed;        //!< GPU memory used by part geometry (MB).
+  int CpuMemoryUsed;        //!< CPU memory used by decoded and staged meshes (MB).
+  int EvictionCount;        //!< Total number of evictions by the residency manager.
+
+  int PendingRequests;      //!< Number of parts waiting for geometry loading.
+  int DeferredRequests;     //!< Number of requests exceeding the per-frame budget.
 };
 
 //! Visualization settings.
@@ -100,7 +121,10 @@ struct JTVis_Settings
                   bool  theBenchmarkingMode    = false,
                   float theLodQuality         = 1.f,
                   bool  theCameraAnimated     = true,
-                  QColor theSelectionColor    = QColor (0, 255, 255))
+                  QColor theSelectionColor    = QColor (0, 255, 255),
+                  int   theGpuMemoryBudget    = 1024,
+                  int   theCpuMemoryBudget    = 2048,
+                  int   theUploadBudget       = 4096)
   : IsViewCullingEnabled (theViewCullingEnabled),
     IsSizeCullingEnabled (theSizeCullingEnabled),
     IsStatsOsdVisible    (theStatsOsdVisible),
@@ -108,7 +132,10 @@ struct JTVis_Settings
     IsBenchmarkingMode   (theBenchmarkingMode),
     LodQuality           (theLodQuality),
     IsCameraAnimated     (theCameraAnimated),
-    SelectionColor       (theSelectionColor)
+    SelectionColor       (theSelectionColor),
+    GpuMemoryBudget      (theGpuMemoryBudget),
+    CpuMemoryBudget      (theCpuMemoryBudget),
+    UploadBudget         (theUploadBudget)
   {}
 
   bool IsViewCullingEnabled; //!< Indicates when viewer will perform view area culling.
@@ -125,6 +152,11 @@ struct JTVis_Settings
 
   QColor SelectionColor;     //!< Color of selected objects.
 
+  int GpuMemoryBudget;       //!< Budget of GPU memory for part geometry (MB, 0 for unlimited).
+  int CpuMemoryBudget;       //!< Budget of CPU memory for decoded meshes (MB, 0 for unlimited).
+
+  int UploadBudget;          //!< Budget of geometry upload to GPU per frame (KB, 0 for unlimited).
+
 };
 
 //! Helper object to load OpenGL VAO functions.
@@ -328,9 +360,18 @@ private:
   //! Traverses scenegraph applying given task.
   void WalkScenegraph (JTVis_ScenegraphTaskPtr theTask);
 
-  //! Traverses scenegraph updating LOD states of nodes.
+  //! Traverses scenegraph updating LOD states of nodes. While the geometry of
+  //! the representation selected by a range LOD is not uploaded, the coarsest
+  //! representation is drawn instead.
   void UpdateLods();
 
+  //! Requests geometry for the parts of the LOD representation without drawing
+  //! them. Returns true if the geometry of all the parts is uploaded.
+  bool RequestLodGeometry (JTData_Node* theNode);
+
+  //! Collects mesh sources of the parts in the subtree.
+  void CollectMeshSources (JTData_Node* theNode, std::vector<JTData_MeshNodeSource*>& theSources);
+
   //! Loads shaders.
   void PrepareShaders();
 
@@ -340,9 +381,26 @@ private:
   //! Handles camera control operations.
   void HandleCamera (float theDeltaTime);
 
-  //! Requests geometry extraction from data source.
-  //! If data is ready, loads triangulation to GPU.
-  void RequestGeometryForNode (JTVis_PartNode* theNode);
+  //! Requests geometry extraction from data source with the given priority.
+  //! If data is ready, puts small triangulation to the aggregator directly
+  //! or passes it to the stager preparing the data for upload to GPU.
+  void RequestGeometryForNode (JTVis_PartNode* theNode, const float thePriority = 0.f);
+
+  //! Uploads to GPU the staged geometry by portions fitting the per-frame upload budget.
+  void UploadStagedGeometry();
+
+  //! Makes the new geometry of the mesh source available to all its instances.
+  void AddPartGeometry (JTData_MeshNodeSource* theSource, const JTVis_PartGeometryPtr& theGeometry);
+
+  //! Returns loading priority of a part with the given bounds: its projected screen size.
+  float LoadingPriority (const JTCommon_AABB& theBox);
+
+  //! Evicts geometry exceeding memory budgets and updates memory statistics.
+  void EvictGeometry();
+
+  //! Requests geometry for the parts collected during the frame in priority
+  //! order, keeping at most the given number of loading requests pending.
+  void ServeLoadingRequests (const int theBudget);
 
   //! Recreates FBOs for current viewport.
   void ResetFbos();
@@ -405,8 +463,41 @@ private:
 
   QMap<JTData_MeshNodeSource*, JTVis_PartGeometryPtr> myInstancedMeshes; //!< Map to determine whenever PartGeometry may be instanced.
 
-  unsigned int myUnloadCheckPeriod; //!< Frame count between unload checks.
-  unsigned int myOldFrameCount;     //!< Nodes with state outdated for myOldFrameCount frames treated as old.
+  JTVis_ResidencyManager myResidencyManager; //!< Keeps part geometry within memory budgets.
+
+  //! Request of part geometry made during a frame.
+  struct LoadingRequest
+  {
+    float           Priority; //!< Loading priority of the part.
+    JTVis_PartNode* PartNode; //!< Part requesting the geometry.
+
+    //! Orders requests by descending priority.
+    bool operator< (const LoadingRequest& theOther) const
+    {
+      return Priority > theOther.Priority;
+    }
+  };
+
+  std::vector<LoadingRequest> myLoadingRequests; //!< Geometry requests of the current frame.
+
+  std::vector<LoadingRequest> myLodRequests; //!< Geometry requests of the LOD representations not drawn yet.
+
+  QSet<JTData_RangeLODNode*> myCoarseLods; //!< Range LODs drawn with the coarsest representation.
+
+  std::vector<JTData_MeshNodeSource*> myReplacedLods; //!< Sources of the coarse representations to release.
+
+  JTVis_GeometryStager myGeometryStager; //!< Prepares geometry for upload on worker threads.
+
+  //! Part geometry being uploaded to GPU by portions.
+  struct PendingUpload
+  {
+    JTVis_StagedMeshPtr   Mesh;     //!< Staged data being uploaded.
+    JTVis_PartGeometryPtr Geometry; //!< Geometry the data is uploaded to.
+  };
+
+  QList<PendingUpload> myPendingUploads; //!< Uploads continued in the next frames, in order.
+
+  size_t myUploadedBytes; //!< Size of geometry uploaded to GPU during the current frame.
 
   std::set<JTVis_PartNode*> mySelectedParts; //!< Set of selected nodes.
 
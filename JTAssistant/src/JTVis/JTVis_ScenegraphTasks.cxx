@@ -189,33 +189,6 @@ void JTVis_GenerateCentersTask::Traverse (QStack<JTVis_ScenegraphTaskPtr>& theSt
   }
 }
 
-// =======================================================================
-// function : Perform
-// purpose  :
-// =======================================================================
-void JTVis_UnloadOldTask::Perform (QStack<JTVis_ScenegraphTaskPtr>& theStack)
-{
-  Q_UNUSED (theStack)
-
-  if (!myNode.dynamicCast<JTData_MeshNode>().isNull())
-  {
-    JTData_MeshNodePtr aMesh = myNode.dynamicCast<JTData_MeshNode>();
-    JTVis_PartNodePtr aPartNode = SceneMeshToPartMap().value (aMesh.data());
-
-    if (aPartNode != NULL)
-    {
-      long long int aStateDelta = qMax (SceneCurrentState() - aMesh->State(),
-                                        SceneCurrentState() - aPartNode->State());
-
-      if (aStateDelta > SceneOldFrameCount() && aPartNode->IsReady())
-      {
-        if (!aPartNode->Geometry()->UsesAggregator())
-          aPartNode->Clear();
-      }
-    }
-  }
-}
-
 // =======================================================================
 // function : Perform
 // purpose  :
@@ -62,7 +62,6 @@ protected:
   JTData_GeometrySourcePtr& SceneGeometrySource() { return myScene->myGeometrySource; }
   BVH_Geometry<float, 4>& SceneBvhGeometry() { return myScene->myBvhGeometry; }
   long long int& SceneCurrentState() { return myScene->myCurrentState; }
-  unsigned int& SceneOldFrameCount() { return myScene->myOldFrameCount; }
   JTVis_TargetedCameraPtr& SceneCamera() { return myScene->myCamera; }
   std::set<JTVis_PartNode*>& SceneSelectedParts() { return myScene->mySelectedParts; }
   QOpenGLShaderProgram* SceneLinesShaderProgram() { return myScene->myLinesShaderProgram; }
@@ -146,23 +145,6 @@ public:
 
 };
 
-//! Unloads nodes completely not visible for OldFrameCount frames.
-class JTVis_UnloadOldTask: public JTVis_ScenegraphTask
-{
-public:
-
-  JTVis_UnloadOldTask (JTVis_Scene* theScene, const JTData_NodePtr& theNode)
-    : JTVis_ScenegraphTask (theScene, theNode) {}
-
-  void Perform (QStack<JTVis_ScenegraphTaskPtr>& theStack);
-
-  const JTVis_ScenegraphTaskPtr Copy (const JTData_NodePtr& theNode)
-  {
-    return JTVis_ScenegraphTaskPtr (new JTVis_UnloadOldTask (myScene, theNode));
-  }
-
-};
-
 //! Selects scenegraph subtree.
 class JTVis_SelectTask: public JTVis_ScenegraphTask
 {
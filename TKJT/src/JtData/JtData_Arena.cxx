@@ -0,0 +1,152 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include <JtData_Arena.hxx>
+#include <JtData_Parallel.hxx>
+
+namespace
+{
+  //! Arena current for the thread.
+  JT_THREAD_LOCAL JtData_Arena* THE_CURRENT_ARENA = 0L;
+
+  //! Round the size up to the arena alignment.
+  inline Standard_Size alignSize (const Standard_Size theSize)
+  {
+    return (theSize + JtData_Arena::Alignment - 1) & ~(JtData_Arena::Alignment - 1);
+  }
+}
+
+//! Chunk header; the chunk memory follows it.
+struct JtData_Arena::Chunk
+{
+  Chunk*        Next;     //!< next chunk in the list
+  Standard_Size Size;     //!< number of usable bytes
+  Standard_Size Used;     //!< number of allocated bytes
+  char*         Data;     //!< aligned start of the usable bytes
+};
+
+//=======================================================================
+//function : JtData_Arena
+//purpose  : Constructor
+//=======================================================================
+
+JtData_Arena::JtData_Arena (const Standard_Size theChunkSize)
+: myChunk     (0L)
+, myChunkSize (alignSize (theChunkSize))
+, myAllocated (0) {}
+
+//=======================================================================
+//function : ~JtData_Arena
+//purpose  : Destructor
+//=======================================================================
+
+JtData_Arena::~JtData_Arena()
+{
+  while (myChunk)
+  {
+    Chunk* aNext = myChunk->Next;
+    Standard::Free (reinterpret_cast<Standard_Address&> (myChunk));
+    myChunk = aNext;
+  }
+}
+
+//=======================================================================
+//function : newChunk
+//purpose  : Allocate a chunk able to hold a block of the given size
+//=======================================================================
+
+JtData_Arena::Chunk* JtData_Arena::newChunk (const Standard_Size theSize)
+{
+  Chunk* aChunk = static_cast<Chunk*> (Standard::Allocate (sizeof (Chunk) + Alignment + theSize));
+  if (!aChunk)
+    return 0L;
+
+  char* aData = reinterpret_cast<char*> (aChunk + 1);
+  aChunk->Next = 0L;
+  aChunk->Size = theSize;
+  aChunk->Used = 0;
+  aChunk->Data = aData + (Alignment - reinterpret_cast<Standard_Size> (aData) % Alignment) % Alignment;
+  return aChunk;
+}
+
+//=======================================================================
+//function : Allocate
+//purpose  : Allocate an aligned block
+//=======================================================================
+
+void* JtData_Arena::Allocate (const Standard_Size theSize)
+{
+  const Standard_Size aSize = alignSize (theSize);
+
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  if (!myChunk || myChunk->Used + aSize > myChunk->Size)
+  {
+    if (aSize > myChunkSize / 4)
+    {
+      // Large blocks get dedicated chunks linked behind the current one
+      // so that its remaining space is still used
+      Chunk* aChunk = newChunk (aSize);
+      if (!aChunk)
+        return 0L;
+
+      aChunk->Used = aSize;
+      if (myChunk)
+      {
+        aChunk->Next  = myChunk->Next;
+        myChunk->Next = aChunk;
+      }
+      else
+        myChunk = aChunk;
+
+      myAllocated += aSize;
+      return aChunk->Data;
+    }
+
+    Chunk* aChunk = newChunk (myChunkSize);
+    if (!aChunk)
+      return 0L;
+
+    aChunk->Next = myChunk;
+    myChunk = aChunk;
+  }
+
+  void* aBlock = myChunk->Data + myChunk->Used;
+  myChunk->Used += aSize;
+  myAllocated   += aSize;
+  return aBlock;
+}
+
+//=======================================================================
+//function : Current
+//purpose  : Return the arena current for the calling thread
+//=======================================================================
+
+JtData_Arena* JtData_Arena::Current()
+{
+  return THE_CURRENT_ARENA;
+}
+
+//=======================================================================
+//function : setCurrent
+//purpose  : Make the arena current for the calling thread
+//=======================================================================
+
+void JtData_Arena::setCurrent (JtData_Arena* theArena)
+{
+  THE_CURRENT_ARENA = theArena;
+}
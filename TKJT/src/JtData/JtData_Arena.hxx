@@ -0,0 +1,102 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef _JtData_Arena_HeaderFile
+#define _JtData_Arena_HeaderFile
+
+#include <Standard.hxx>
+#include <Standard_Mutex.hxx>
+
+//! Monotonic allocator for short-lived decoding buffers.
+//!
+//! Memory is taken from large chunks and is released in bulk when the arena
+//! is destroyed; releasing an individual block does nothing. The arena is
+//! thread-safe, so parallel decoding tasks of one segment may share it.
+//!
+//! Vectors (JtData_Vector, JtData_CompVector) allocate their storage from
+//! the arena made current for the calling thread by a Scope object, and from
+//! the heap otherwise. All vectors allocated from an arena must be destroyed
+//! or freed before the arena itself, so results that outlive the decoding
+//! should be allocated with the arena suspended (Scope with a null arena).
+//! Tasks run with JtData_Parallel take the arena current for the thread
+//! that created them, not the one of the thread executing them.
+class JtData_Arena
+{
+public:
+  //! Makes an arena current for the calling thread during its lifetime.
+  class Scope
+  {
+  public:
+    //! Make the given arena current; a null arena suspends arena allocation.
+    explicit Scope (JtData_Arena* theArena) : myPrevious (JtData_Arena::Current())
+    {
+      JtData_Arena::setCurrent (theArena);
+    }
+
+    //! Restore the previously current arena.
+    ~Scope() { JtData_Arena::setCurrent (myPrevious); }
+
+  private:
+    Scope (const Scope&);
+    Scope& operator = (const Scope&);
+
+  private:
+    JtData_Arena* myPrevious;
+  };
+
+  //! Alignment of the allocated blocks.
+  static const Standard_Size Alignment = 16;
+
+  //! Default size of a chunk.
+  static const Standard_Size DefaultChunkSize = 1 << 20;
+
+public:
+  //! Constructor; no memory is allocated until the first request.
+  Standard_EXPORT explicit JtData_Arena (const Standard_Size theChunkSize = DefaultChunkSize);
+
+  //! Destructor releasing all the allocated memory.
+  Standard_EXPORT ~JtData_Arena();
+
+  //! Allocate a block of the given size aligned by Alignment.
+  Standard_EXPORT void* Allocate (const Standard_Size theSize);
+
+  //! Return the total size of the allocated blocks.
+  Standard_Size Allocated() const { return myAllocated; }
+
+  //! Return the arena current for the calling thread or null.
+  Standard_EXPORT static JtData_Arena* Current();
+
+private:
+  struct Chunk;
+
+  //! Make the arena current for the calling thread.
+  Standard_EXPORT static void setCurrent (JtData_Arena* theArena);
+
+  //! Allocate a chunk able to hold a block of the given size.
+  static Chunk* newChunk (const Standard_Size theSize);
+
+  JtData_Arena (const JtData_Arena&);
+  JtData_Arena& operator = (const JtData_Arena&);
+
+private:
+  Chunk*         myChunk;     //!< chunk the blocks are taken from, head of the chunk list
+  Standard_Size  myChunkSize; //!< size of regular chunks
+  Standard_Size  myAllocated; //!< total size of the allocated blocks
+  Standard_Mutex myMutex;
+};
+
+#endif // _JtData_Arena_HeaderFile
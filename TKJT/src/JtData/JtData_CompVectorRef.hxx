@@ -41,6 +41,10 @@ public:
   JtData_CompVectorRef (const JtData_CompVector<ValT, SizeT, CompCountT>& theVector)
     : data (theVector) {}
 
+  //! Copy references the same data, unlike assignment that copies the referenced values.
+  JtData_CompVectorRef (const JtData_CompVectorRef& theOther)
+    : data (theOther.myData, theOther.myCount, theOther.myCompCount) {}
+
   JtData_CompVectorRef& operator = (const JtData_CompVectorRef& theOther)
   {
     if (this->myCount > theOther.myCount)
@@ -16,8 +16,67 @@
 
 #include <JtData_Inflate.hxx>
 
+#if defined(HAVE_LIBDEFLATE)
+  #include <libdeflate.h>
+#elif defined(HAVE_ZLIBNG)
+  #include <zlib-ng.h>
+  #define JT_ZLIB(name) zng_##name
+  #define JT_ZSTREAM    zng_stream
+#else
+  #define JT_ZLIB(name) name
+  #define JT_ZSTREAM    z_stream
+#endif
+
 #define min(a, b) ((a) < (b) ? (a) : (b))
 
+namespace
+{
+  //! Initial guess of the inflated size for the given compressed size.
+  inline Standard_Size inflatedSizeGuess (const Standard_Size theLength)
+  {
+    return theLength * 4 + 1024;
+  }
+
+  //! Upper bound of the inflated size for the given compressed size:
+  //! deflate cannot expand data more than 1032 times, larger output means a broken stream.
+  inline Standard_Size inflatedSizeLimit (const Standard_Size theLength)
+  {
+    static const Standard_Size MAX_RATIO = 1032;
+    return theLength < (~static_cast<Standard_Size> (0) - 1024) / MAX_RATIO
+         ? theLength * MAX_RATIO + 1024
+         : ~static_cast<Standard_Size> (0);
+  }
+
+#if !defined(HAVE_LIBDEFLATE)
+  //! Grow the vector twice, not above the given limit, preserving its first theSize bytes.
+  Standard_Boolean growBuffer (JtData_Vector<Jt_U8>& theData,
+                               const Standard_Size   theSize,
+                               const Standard_Size   theLimit)
+  {
+    if (theData.Count() >= theLimit)
+      return Standard_False;
+
+    JtData_Vector<Jt_U8> aLarger (Min (theData.Count() * 2, theLimit));
+    if (aLarger.IsEmpty())
+      return Standard_False;
+
+    memcpy (aLarger.Data(), theData.Data(), theSize);
+    theData << aLarger;
+    return Standard_True;
+  }
+#endif
+
+  //! Shrink the vector to the given size.
+  void shrinkBuffer (JtData_Vector<Jt_U8>& theData, const Standard_Size theSize)
+  {
+    if (theSize < theData.Count())
+    {
+      JtData_Vector<Jt_U8> aShrinked (JtData_Vector<Jt_U8>::Ref (theData.Data(), theSize));
+      theData << aShrinked;
+    }
+  }
+}
+
 //=======================================================================
 //function : JtData_Inflate
 //purpose  : Constructor
@@ -30,6 +89,7 @@ JtData_Inflate::JtData_Inflate (JtData_Reader& theReader, const Standard_Size th
   , myInputRest   (theLength)
   , myOutBufPos   (myOutBuffer)
   , myOutBufRest  (0)
+  , myTotalOut    (0)
 {
   myZStream.avail_in  = 0;
   myZStream.next_in   = Z_NULL;
@@ -120,7 +180,110 @@ Standard_Boolean JtData_Inflate::SkipBytes (Standard_Size theLength)
 
 Standard_Size JtData_Inflate::GetPosition() const
 {
-  return myZStream.total_out - myOutBufRest;
+  return myTotalOut - myOutBufRest;
+}
+
+//=======================================================================
+//function : InflateBuffer
+//purpose  : Inflate a whole zlib stream from memory into a single buffer
+//=======================================================================
+
+Standard_Boolean JtData_Inflate::InflateBuffer (const void*           theData,
+                                                const Standard_Size   theLength,
+                                                JtData_Vector<Jt_U8>& theResult)
+{
+  const Standard_Size aLimit = inflatedSizeLimit (theLength);
+  JtData_Vector<Jt_U8> aData (inflatedSizeGuess (theLength));
+  if (aData.IsEmpty())
+    return Standard_False;
+
+#if defined(HAVE_LIBDEFLATE)
+  libdeflate_decompressor* aDecompressor = libdeflate_alloc_decompressor();
+  if (!aDecompressor)
+    return Standard_False;
+
+  // libdeflate needs the whole output buffer, retry with a larger one if it is too small
+  size_t aSize = 0;
+  libdeflate_result aResult;
+  while ((aResult = libdeflate_zlib_decompress (aDecompressor, theData, theLength,
+                                                aData.Data(), aData.Count(), &aSize))
+         == LIBDEFLATE_INSUFFICIENT_SPACE)
+  {
+    if (aData.Count() >= aLimit
+     || !aData.Allocate (Min (aData.Count() * 2, aLimit))
+     || aData.IsEmpty())
+    {
+      break;
+    }
+  }
+
+  libdeflate_free_decompressor (aDecompressor);
+  if (aResult != LIBDEFLATE_SUCCESS)
+    return Standard_False;
+#else
+  // zlib counters are 32-bit, so the input and output are passed in pieces
+  static const Standard_Size MAX_AVAIL = 0x40000000;
+
+  JT_ZSTREAM aStream;
+  memset (&aStream, 0, sizeof (aStream));
+  if (JT_ZLIB(inflateInit) (&aStream) != Z_OK)
+    return Standard_False;
+
+  const Bytef*  anInput = static_cast<const Bytef*> (theData);
+  Standard_Size anInPos = 0;
+  Standard_Size aSize   = 0;
+  int aResult = Z_OK;
+  while (aResult == Z_OK)
+  {
+    if (aSize == aData.Count() && !growBuffer (aData, aSize, aLimit))
+    {
+      aResult = Z_MEM_ERROR;
+      break;
+    }
+
+    const Standard_Size anInPiece  = min (theLength - anInPos,     MAX_AVAIL);
+    const Standard_Size anOutPiece = min (aData.Count() - aSize, MAX_AVAIL);
+    aStream.next_in   = const_cast<Bytef*> (anInput + anInPos);
+    aStream.avail_in  = static_cast<unsigned> (anInPiece);
+    aStream.next_out  = aData.Data() + aSize;
+    aStream.avail_out = static_cast<unsigned> (anOutPiece);
+
+    aResult = JT_ZLIB(inflate) (&aStream, Z_NO_FLUSH);
+
+    anInPos += anInPiece  - aStream.avail_in;
+    aSize   += anOutPiece - aStream.avail_out;
+
+    // no progress: continue if only the output space is exhausted
+    if (aResult == Z_BUF_ERROR && aSize == aData.Count())
+      aResult = Z_OK;
+  }
+
+  JT_ZLIB(inflateEnd) (&aStream);
+
+  // a stream without end marker is accepted if all input is consumed, as JtData_Inflate does
+  if (aResult != Z_STREAM_END && !(aResult == Z_BUF_ERROR && anInPos == theLength))
+    return Standard_False;
+#endif
+
+  shrinkBuffer (aData, aSize);
+  theResult << aData;
+  return Standard_True;
+}
+
+//=======================================================================
+//function : BackendName
+//purpose  : Return name of the backend used by InflateBuffer()
+//=======================================================================
+
+const char* JtData_Inflate::BackendName()
+{
+#if defined(HAVE_LIBDEFLATE)
+  return "libdeflate";
+#elif defined(HAVE_ZLIBNG)
+  return "zlib-ng";
+#else
+  return "zlib";
+#endif
 }
 
 //=======================================================================
@@ -129,6 +292,31 @@ Standard_Size JtData_Inflate::GetPosition() const
 //=======================================================================
 
 Standard_Size JtData_Inflate::read (Bytef* theBuffer, Standard_Size theLength)
+{
+  // zlib counters are 32-bit (uInt, and uLong on LLP64 hosts),
+  // so the output is processed in pieces and counted separately
+  static const Standard_Size MAX_AVAIL_OUT = 0x40000000;
+
+  Standard_Size aRead = 0;
+  while (aRead < theLength)
+  {
+    const Standard_Size aPiece = min (MAX_AVAIL_OUT, theLength - aRead);
+    const Standard_Size aDone  = readPiece (theBuffer + aRead, aPiece);
+    aRead      += aDone;
+    myTotalOut += aDone;
+    if (aDone < aPiece)
+      break;
+  }
+
+  return aRead;
+}
+
+//=======================================================================
+//function : readPiece
+//purpose  : unbuffered inflate of less than 4 GB
+//=======================================================================
+
+Standard_Size JtData_Inflate::readPiece (Bytef* theBuffer, Standard_Size theLength)
 {
   myZStream.next_out  = theBuffer;
   myZStream.avail_out = static_cast<unsigned>(theLength);
@@ -40,8 +40,18 @@ public:
   //! Get absolute reading position in the inflated data.
   Standard_EXPORT virtual Standard_Size GetPosition() const;
 
+  //! Inflate a whole zlib stream from memory into a single buffer
+  //! using the backend selected at build time (libdeflate, zlib-ng or zlib).
+  Standard_EXPORT static Standard_Boolean InflateBuffer (const void*           theData,
+                                                         const Standard_Size   theLength,
+                                                         JtData_Vector<Jt_U8>& theResult);
+
+  //! Return name of the backend used by InflateBuffer().
+  Standard_EXPORT static const char* BackendName();
+
 protected:
-  Standard_Size read (Bytef* theBuffer, Standard_Size theLength);
+  Standard_Size read      (Bytef* theBuffer, Standard_Size theLength);
+  Standard_Size readPiece (Bytef* theBuffer, Standard_Size theLength);
 
 protected:
   static const Standard_Size CHUNK = 32768;
@@ -55,6 +65,8 @@ protected:
   Bytef          myOutBuffer[CHUNK];
   const Bytef*   myOutBufPos;
   Standard_Size  myOutBufRest;
+
+  Standard_Size  myTotalOut;
 };
 
 #endif // _JtData_Inflate_HeaderFile
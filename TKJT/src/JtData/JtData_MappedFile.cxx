@@ -0,0 +1,176 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+#include <JtData_MappedFile.hxx>
+
+#include <TCollection_AsciiString.hxx>
+
+#ifdef WNT
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+//=======================================================================
+//function : JtData_MappedFile
+//purpose  : Constructor
+//=======================================================================
+
+JtData_MappedFile::JtData_MappedFile()
+: myData (0L)
+, mySize (0)
+#ifdef WNT
+, myFileHandle    (INVALID_HANDLE_VALUE)
+, myMappingHandle (NULL)
+#endif
+{}
+
+//=======================================================================
+//function : ~JtData_MappedFile
+//purpose  : Destructor
+//=======================================================================
+
+JtData_MappedFile::~JtData_MappedFile()
+{
+  Close();
+}
+
+//=======================================================================
+//function : Open
+//purpose  : Map the file with the given name to memory
+//=======================================================================
+
+Standard_Boolean JtData_MappedFile::Open (const TCollection_ExtendedString& theFileName)
+{
+  Close();
+
+#ifdef WNT
+  myFileHandle = CreateFileW (reinterpret_cast<const wchar_t*> (theFileName.ToExtString()),
+                              GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+  if (myFileHandle == INVALID_HANDLE_VALUE)
+    return Standard_False;
+
+  LARGE_INTEGER aSize;
+  if (!GetFileSizeEx (myFileHandle, &aSize)
+   || aSize.QuadPart <= 0
+   || static_cast<ULONGLONG> (aSize.QuadPart) > static_cast<ULONGLONG> (static_cast<Standard_Size> (-1)))
+  {
+    Close();
+    return Standard_False;
+  }
+
+  myMappingHandle = CreateFileMappingW (myFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (myMappingHandle == NULL)
+  {
+    Close();
+    return Standard_False;
+  }
+
+  myData = static_cast<const uint8_t*> (MapViewOfFile (myMappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!myData)
+  {
+    Close();
+    return Standard_False;
+  }
+  mySize = static_cast<Standard_Size> (aSize.QuadPart);
+#else
+  TCollection_AsciiString anAsciiName (theFileName, ' ');
+  int aFile = open (anAsciiName.ToCString(), O_RDONLY);
+  if (aFile < 0)
+    return Standard_False;
+
+  struct stat aStat;
+  if (fstat (aFile, &aStat) != 0
+   || aStat.st_size <= 0
+   || static_cast<uint64_t> (aStat.st_size) > static_cast<uint64_t> (static_cast<Standard_Size> (-1)))
+  {
+    close (aFile);
+    return Standard_False;
+  }
+
+  void* anAddress = mmap (0L, static_cast<Standard_Size> (aStat.st_size), PROT_READ, MAP_SHARED, aFile, 0);
+
+  // the mapping keeps its own reference to the file
+  close (aFile);
+
+  if (anAddress == MAP_FAILED)
+    return Standard_False;
+
+  myData = static_cast<const uint8_t*> (anAddress);
+  mySize = static_cast<Standard_Size> (aStat.st_size);
+#endif
+
+  return Standard_True;
+}
+
+//=======================================================================
+//function : Close
+//purpose  : Unmap the file
+//=======================================================================
+
+void JtData_MappedFile::Close()
+{
+#ifdef WNT
+  if (myData)
+    UnmapViewOfFile (myData);
+  if (myMappingHandle != NULL)
+    CloseHandle (myMappingHandle);
+  if (myFileHandle != INVALID_HANDLE_VALUE)
+    CloseHandle (myFileHandle);
+
+  myMappingHandle = NULL;
+  myFileHandle    = INVALID_HANDLE_VALUE;
+#else
+  if (myData)
+    munmap (const_cast<uint8_t*> (myData), mySize);
+#endif
+
+  myData = 0L;
+  mySize = 0;
+}
+
+//=======================================================================
+//function : Prefetch
+//purpose  : Hint the system to page in the given range of the file
+//=======================================================================
+
+void JtData_MappedFile::Prefetch (const uint64_t theOffset, const uint64_t theLength) const
+{
+  if (!myData || theOffset >= mySize)
+    return;
+
+  const uint64_t      aLimit = static_cast<uint64_t> (mySize);
+  const Standard_Size anEnd  = static_cast<Standard_Size> (Min (theOffset + theLength, aLimit));
+
+#ifdef WNT
+  // touch one byte per page; this pulls the range into the working set
+  // with read-ahead of the memory manager
+  const Standard_Size aPageSize = 4096;
+  volatile uint8_t aSum = 0;
+  for (Standard_Size aPos = static_cast<Standard_Size> (theOffset); aPos < anEnd; aPos += aPageSize)
+    aSum += myData[aPos];
+  (void )aSum;
+#else
+  // madvise() requires a page aligned address
+  const Standard_Size aPageSize = static_cast<Standard_Size> (sysconf (_SC_PAGESIZE));
+  const Standard_Size aStart    = static_cast<Standard_Size> (theOffset) / aPageSize * aPageSize;
+  madvise (const_cast<uint8_t*> (myData) + aStart, anEnd - aStart, MADV_WILLNEED);
+#endif
+}
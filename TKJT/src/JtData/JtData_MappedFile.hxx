@@ -0,0 +1,70 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+#ifndef _JtData_MappedFile_HeaderFile
+#define _JtData_MappedFile_HeaderFile
+
+#include <Standard.hxx>
+#include <TCollection_ExtendedString.hxx>
+
+//! Read-only memory mapping of a whole file.
+class JtData_MappedFile
+{
+public:
+  //! Constructor.
+  Standard_EXPORT JtData_MappedFile();
+
+  //! Destructor; unmaps the file.
+  Standard_EXPORT ~JtData_MappedFile();
+
+  //! Map the file with the given name to memory.
+  //! Returns false if the file cannot be opened or mapped
+  //! (e.g. it does not fit into the address space).
+  Standard_EXPORT Standard_Boolean Open (const TCollection_ExtendedString& theFileName);
+
+  //! Unmap the file.
+  Standard_EXPORT void Close();
+
+  //! Hint the system to page in the given range of the file in background.
+  Standard_EXPORT void Prefetch (const uint64_t theOffset, const uint64_t theLength) const;
+
+  //! Return true if the file is mapped.
+  Standard_Boolean IsOpen() const { return myData != 0L; }
+
+  //! Return the address of the first byte of the mapping.
+  const uint8_t*   Data()   const { return myData; }
+
+  //! Return size of the mapped file in bytes.
+  Standard_Size    Size()   const { return mySize; }
+
+private:
+  //! Copying is prohibited.
+  JtData_MappedFile (const JtData_MappedFile&);
+  JtData_MappedFile& operator = (const JtData_MappedFile&);
+
+private:
+  const uint8_t* myData;
+  Standard_Size  mySize;
+#ifdef WNT
+  void*          myFileHandle;
+  void*          myMappingHandle;
+#endif
+
+public:
+  DEFINE_STANDARD_ALLOC
+};
+
+#endif // _JtData_MappedFile_HeaderFile
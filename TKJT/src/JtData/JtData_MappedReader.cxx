@@ -0,0 +1,104 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include <JtData_MappedReader.hxx>
+
+#include <cstring>
+
+//=======================================================================
+//function : JtData_MappedReader
+//purpose  : Constructor
+//=======================================================================
+
+JtData_MappedReader::JtData_MappedReader (const uint8_t*              theData,
+                                          const Standard_Size         theSize,
+                                          const Handle(JtData_Model)& theModel,
+                                          const Standard_Size         theOffset)
+  : JtData_Reader (theModel)
+  , myData        (theData)
+  , mySize        (theSize)
+  , myPos         (theOffset < theSize ? theOffset : theSize) {}
+
+//=======================================================================
+//function : ReadBytes
+//purpose  : Read raw bytes from the mapping
+//=======================================================================
+
+Standard_Boolean JtData_MappedReader::ReadBytes (void* theBuffer, Standard_Size theLength)
+{
+  if (theLength > mySize - myPos)
+  {
+    myPos = mySize;
+    return Standard_False;
+  }
+
+  memcpy (theBuffer, myData + myPos, theLength);
+  myPos += theLength;
+  return Standard_True;
+}
+
+//=======================================================================
+//function : SkipBytes
+//purpose  : Skip some bytes
+//=======================================================================
+
+Standard_Boolean JtData_MappedReader::SkipBytes (Standard_Size theLength)
+{
+  if (theLength > mySize - myPos)
+  {
+    myPos = mySize;
+    return Standard_False;
+  }
+
+  myPos += theLength;
+  return Standard_True;
+}
+
+//=======================================================================
+//function : GetPosition
+//purpose  : Get absolute reading position
+//=======================================================================
+
+Standard_Size JtData_MappedReader::GetPosition() const
+{
+  return myPos;
+}
+
+//=======================================================================
+//function : LoadBytes
+//purpose  : Return a pointer to the mapped data and advance the position
+//=======================================================================
+
+const void* JtData_MappedReader::LoadBytes (const Standard_Size theLength)
+{
+  if (theLength > mySize - myPos)
+  {
+    myPos = mySize;
+    return 0L;
+  }
+
+  const void* anAddress = myData + myPos;
+  myPos += theLength;
+  return anAddress;
+}
+
+//=======================================================================
+//function : UnloadBytes
+//purpose  : Nothing to free for mapped data
+//=======================================================================
+
+void JtData_MappedReader::UnloadBytes (const void* /*theAddress*/) {}
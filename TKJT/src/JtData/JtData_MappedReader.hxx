@@ -0,0 +1,58 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef _JtData_MappedReader_HeaderFile
+#define _JtData_MappedReader_HeaderFile
+
+#include <JtData_Reader.hxx>
+
+//! Reader of a memory-mapped file. Load() returns pointers
+//! directly into the mapping without copying the data.
+class JtData_MappedReader : public JtData_Reader
+{
+public:
+  //! Constructor.
+  //! @param theData - address of the first byte of the mapped file
+  //! @param theSize - size of the mapped file
+  //! @param theOffset - initial reading position
+  Standard_EXPORT JtData_MappedReader (const uint8_t*              theData,
+                                       const Standard_Size         theSize,
+                                       const Handle(JtData_Model)& theModel,
+                                       const Standard_Size         theOffset = 0);
+
+  //! Read raw bytes from the mapping.
+  Standard_EXPORT virtual Standard_Boolean ReadBytes (void* theBuffer, Standard_Size theLength);
+
+  //! Skip some bytes.
+  Standard_EXPORT virtual Standard_Boolean SkipBytes (Standard_Size theLength);
+
+  //! Get absolute reading position.
+  Standard_EXPORT virtual Standard_Size GetPosition() const;
+
+  //! Return a pointer to the mapped data and advance the position.
+  Standard_EXPORT virtual const void* LoadBytes (const Standard_Size theLength);
+
+  //! Nothing to free for mapped data.
+  Standard_EXPORT virtual void UnloadBytes (const void* theAddress);
+
+protected:
+  const uint8_t* myData;
+  Standard_Size  mySize;
+  Standard_Size  myPos;
+};
+
+#endif // _JtData_MappedReader_HeaderFile
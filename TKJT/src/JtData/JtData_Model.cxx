@@ -15,11 +15,15 @@
 // on <http://www.gnu.org/licenses/>.
 
 #include <JtData_Model.hxx>
-#include <JtData_FileReader.hxx>
+#include <JtData_MappedReader.hxx>
+#include <JtData_PooledReader.hxx>
+#include <JtData_SingleHandle.hxx>
 #include <JtData_Inflate.hxx>
 
 #include <JtData_Message.hxx>
+#include <JtData_Parallel.hxx>
 
+#include <JtElement_ShapeLOD_Vertex.hxx>
 #include <JtNode_Partition.hxx>
 #include <JtProperty_LateLoaded.hxx>
 #include <JtProperty_String.hxx>
@@ -30,11 +34,49 @@
 #include <TCollection_AsciiString.hxx>
 #include <TColStd_SequenceOfInteger.hxx>
 
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <utility>
+#include <vector>
+
 const Standard_Boolean JtData_Model::IsLittleEndianHost =
   Image_PixMap::IsBigEndianHost() ? Standard_False : Standard_True;
 
 static const Jt_GUID EOEMarkerGUID ("ffffffff-ffff-ffff-ff-ff-ff-ff-ff-ff-ff-ff");
 
+#ifdef OCCT_DEBUG
+//! Format a 64-bit file offset for messages.
+static TCollection_AsciiString offsetString (const Jt_U64 theOffset)
+{
+  char aBuffer[24];
+  sprintf (aBuffer, "%llu", static_cast<unsigned long long> (theOffset));
+  return TCollection_AsciiString (aBuffer);
+}
+#endif
+
+//! Task loading the segment of a late loaded property.
+class JtData_Model_LoadSegmentTask
+{
+public:
+  JtData_Model_LoadSegmentTask (const Handle(JtProperty_LateLoaded)& theProperty,
+                                JtData_Model::LoadCallback*          theCallback,
+                                JtElement_ShapeLOD_Sink*             theSink)
+    : myProperty (theProperty), myCallback (theCallback), mySink (theSink) {}
+
+  void operator ()() const
+  {
+    myProperty->Load (mySink);
+    if (myCallback)
+      myCallback->SegmentLoaded (myProperty);
+  }
+
+private:
+  Handle(JtProperty_LateLoaded) myProperty;
+  JtData_Model::LoadCallback*   myCallback;
+  JtElement_ShapeLOD_Sink*      mySink;
+};
+
 IMPLEMENT_STANDARD_HANDLE (JtData_Model, MMgt_TShared)
 IMPLEMENT_STANDARD_RTTIEXT(JtData_Model, MMgt_TShared)
 
@@ -56,19 +98,23 @@ JtData_Model::JtData_Model (const TCollection_ExtendedString& theFileName,
 //=======================================================================
 Handle(JtNode_Partition) JtData_Model::Init()
 {
-  // Open the file
-  std::ifstream aFile;
-  if (!open (aFile))
+  // Map the file to memory, fall back to positional reading if mapping fails
+  if (!myMappedFile.Open (myFileName) && !mySharedFile.Open (myFileName))
   {
     ALARM ("Error: Failed to open Jt file");
     return Handle(JtNode_Partition)();
   }
 
   // Read File Header
+  JtData_SingleHandle<JtData_Reader> aHeaderReader (newReader (0));
 
   // Read version
   char vstr[81] = {};
-  aFile.read (vstr, 80);
+  if (!aHeaderReader->Read (vstr, 80))
+  {
+    ALARM ("Error: Failed to read Jt file version");
+    return Handle(JtNode_Partition)();
+  }
 
   TCollection_AsciiString aMajorVersionStr (vstr);
   Standard_Integer aPos = aMajorVersionStr.Search ("Version");
@@ -101,18 +147,25 @@ Handle(JtNode_Partition) JtData_Model::Init()
 
   // Read byte order
   char aByteOrder;
-  aFile.read (&aByteOrder, 1);
+  if (!aHeaderReader->Read (&aByteOrder, 1))
+  {
+    ALARM ("Error: Failed to read Jt file byte order");
+    return Handle(JtNode_Partition)();
+  }
   myIsFileLE = (aByteOrder == 0);
   TRACE ("Info: Byte order = " + (myIsFileLE ? "LE" : "BE"));
 
   // Read reserved field, TOC offset, LSG Segment ID
-  Jt_I32 aReservedField, aTOCOffset;
+  // (with a new reader since byte swapping depends on the byte order)
+  // (TOC offset is 64-bit starting from JT 10)
+  Jt_I32 aReservedField;
+  Jt_U64 aTOCOffset;
   Jt_GUID anLSGSegmentGUID;
   {
-    JtData_FileReader aReader (aFile, this);
-    if (!aReader.ReadI32 (aReservedField)
-     || !aReader.ReadI32 (aTOCOffset)
-     || !aReader.ReadGUID (anLSGSegmentGUID))
+    JtData_SingleHandle<JtData_Reader> aReader (newReader (81));
+    if (!aReader->ReadI32 (aReservedField)
+     || !readOffset (*aReader, aTOCOffset)
+     || !aReader->ReadGUID (anLSGSegmentGUID))
     {
       ALARM ("Error: Failed to read TOC offset and LSG segment ID");
       return Handle(JtNode_Partition)();
@@ -120,55 +173,89 @@ Handle(JtNode_Partition) JtData_Model::Init()
   }
 
   // Read TOC
-  if (!readTOC (aFile, aTOCOffset))
+  if (!readTOC (aTOCOffset))
   {
     ALARM ("Error: Failed to read TOC");
     return Handle(JtNode_Partition)();
   }
 
   // Find and read LSG segment
-  Jt_I32 anLSGSegmentOffset;
-  if (!myTOC.Find (anLSGSegmentGUID, anLSGSegmentOffset))
+  SegmentInfo anLSGSegment;
+  if (!myTOC.Find (anLSGSegmentGUID, anLSGSegment))
   {
     ALARM ("Error: No LSG segment");
     return Handle(JtNode_Partition)();
   }
   else
   {
-    TRACE ("Info: LSG segment is found at offset " + anLSGSegmentOffset);
+    TRACE ("Info: LSG segment is found at offset " + offsetString (anLSGSegment.Offset));
   }
 
-  Handle(JtData_Object) aRootNode = readSegment (aFile, anLSGSegmentOffset, Standard_True);
-
-  aFile.close();
+  Handle(JtData_Object) aRootNode = readSegment (anLSGSegment.Offset, Standard_True);
 
   return Handle(JtNode_Partition)::DownCast (aRootNode);
 }
 
 //=======================================================================
-//function : open
-//purpose  : Open the file
+//function : newReader
+//purpose  : Create a reader of the file mapping or a pooled file reader
 //=======================================================================
-Standard_Boolean JtData_Model::open (ifstream& aFile) const
+JtData_Reader* JtData_Model::newReader (const Jt_U64 theOffset) const
 {
-#ifdef WNT
-  aFile.open (reinterpret_cast<const wchar_t*> (myFileName.ToExtString()),
-              ios::binary | ios::in);
-#else
-  TCollection_AsciiString anAsciiName (myFileName, ' ');
-  aFile.open (anAsciiName.ToCString(), ios::binary | ios::in);
-#endif
+  if (myMappedFile.IsOpen())
+    return new JtData_MappedReader (myMappedFile.Data(), myMappedFile.Size(),
+                                    this, static_cast<Standard_Size> (theOffset));
+
+  return new JtData_PooledReader (mySharedFile, this, theOffset);
+}
+
+//=======================================================================
+//function : isCompressible
+//purpose  : Check if data of segments of the given type may be compressed
+//=======================================================================
+Standard_Boolean JtData_Model::isCompressible (const Standard_Integer theType)
+{
+  switch (theType)
+  {
+  case 1:
+  case 2:
+  case 3:
+  case 4:
+  case 17:
+  case 18:
+  case 20:
+  case 24:
+    return Standard_True;
+  }
 
-  return aFile.is_open();
+  return Standard_False;
+}
+
+//=======================================================================
+//function : readOffset
+//purpose  : Read a file offset (I32 before JT 10, U64 since JT 10)
+//=======================================================================
+Standard_Boolean JtData_Model::readOffset (JtData_Reader& theReader, Jt_U64& theOffset) const
+{
+  if (myMajorVersion >= 10)
+    return theReader.ReadU64 (theOffset);
+
+  Jt_I32 anOffset;
+  if (!theReader.ReadI32 (anOffset) || anOffset < 0)
+    return Standard_False;
+
+  theOffset = static_cast<Jt_U64> (anOffset);
+  return Standard_True;
 }
 
 //=======================================================================
 //function : readTOC
 //purpose  : Read TOC from the JT file
 //=======================================================================
-Standard_Boolean JtData_Model::readTOC (std::ifstream& theFile, const Jt_I32 theOffset)
+Standard_Boolean JtData_Model::readTOC (const Jt_U64 theOffset)
 {
-  JtData_FileReader aReader (theFile, this, theOffset);
+  JtData_SingleHandle<JtData_Reader> aReaderHandle (newReader (theOffset));
+  JtData_Reader& aReader = *aReaderHandle;
 
   // Read entry count
   Jt_I32 aCount;
@@ -183,10 +270,11 @@ Standard_Boolean JtData_Model::readTOC (std::ifstream& theFile, const Jt_I32 the
   {
     // Read Segment ID, offset, length, attributes
     Jt_GUID aGUID;
-    Jt_I32 aOffset, aLength;
+    Jt_U64 aOffset;
+    Jt_I32 aLength;
     Jt_U32 aAttrib;
     if (!aReader.ReadGUID (aGUID)
-     || !aReader.ReadI32  (aOffset)
+     || !readOffset       (aReader, aOffset)
      || !aReader.ReadI32  (aLength)
      || !aReader.ReadU32  (aAttrib))
     {
@@ -199,7 +287,12 @@ Standard_Boolean JtData_Model::readTOC (std::ifstream& theFile, const Jt_I32 the
     else
       aTypeMap.Bind (aType, 1);
 
-    myTOC.Bind (aGUID, aOffset);
+    SegmentInfo anInfo;
+    anInfo.Offset         = aOffset;
+    anInfo.Length         = static_cast<Jt_U32> (aLength);
+    anInfo.Type           = aType;
+    anInfo.IsCompressible = isCompressible (aType);
+    myTOC.Bind (aGUID, anInfo);
   }
 
   TRACE ("Info: Type statistics");
@@ -215,11 +308,12 @@ Standard_Boolean JtData_Model::readTOC (std::ifstream& theFile, const Jt_I32 the
 //function : readSegment
 //purpose  : Read objects from a JT file segment
 //=======================================================================
-Handle(JtData_Object) JtData_Model::readSegment (std::ifstream&         theFile,
-                                                 const Jt_I32           theOffset,
-                                                 const Standard_Boolean theIsLSG) const
+Handle(JtData_Object) JtData_Model::readSegment (const Jt_U64             theOffset,
+                                                 const Standard_Boolean   theIsLSG,
+                                                 JtElement_ShapeLOD_Sink* theSink) const
 {
-  JtData_FileReader aReader (theFile, this, theOffset);
+  JtData_SingleHandle<JtData_Reader> aReaderHandle (newReader (theOffset));
+  JtData_Reader& aReader = *aReaderHandle;
 
   Standard_Size aSegStart = aReader.GetPosition();
 
@@ -231,55 +325,102 @@ Handle(JtData_Object) JtData_Model::readSegment (std::ifstream&         theFile,
    || !aReader.ReadI32  (aType)
    || !aReader.ReadI32  (aSize))
   {
-    ALARM ("Error: Failed to read header of segment with offset " + theOffset);
+    ALARM ("Error: Failed to read header of segment with offset " + offsetString (theOffset));
     return Handle(JtData_Object)();
   }
 
-  // Select appropriate reader for reading the segment data:
-  // - use the file reader if the segment is not compressed;
-  // - use JtData_Inflate is the segment is compressed.
-  JtData_Reader* aDataReaderPtr = &aReader;
-  switch (aType)
+  // Inflate compressed segment data to a memory buffer at once
+  NCollection_Handle<JtData_SegmentCache::RawData> aData;
+  if (isCompressible (aType))
   {
-  case 1:
-  case 2:
-  case 3:
-  case 4:
-  case 17:
-  case 18:
-  case 20:
-  case 24:
+    // read Compression Flag, Data Length, Algorithm
+    Jt_I32 aFlag;
+    Jt_I32 aDataLength;
+    Jt_U8  aAlgorithm;
+    if (!aReader.ReadI32 (aFlag)
+     || !aReader.ReadI32 (aDataLength)
+     || !aReader.ReadU8  (aAlgorithm))
+    {
+      ALARM ("Error: Failed to read compression flags of segment with offset " + offsetString (theOffset));
+      return Handle(JtData_Object)();
+    }
+
+    if (aFlag == 2 && aAlgorithm == 2)
     {
-      // read Compression Flag, Data Length, Algorithm
-      Jt_I32 aFlag;
-      Jt_I32 aDataLength;
-      Jt_U8  aAlgorithm;
-      if (!aReader.ReadI32 (aFlag)
-       || !aReader.ReadI32 (aDataLength)
-       || !aReader.ReadU8  (aAlgorithm))
+      // the data length counts the algorithm byte and should not exceed the segment
+      const Standard_Size aHeadLength = aReader.GetPosition() - aSegStart;
+      const Standard_Size aSegRest    = aSize > 0 && static_cast<Standard_Size> (aSize) > aHeadLength
+                                      ? static_cast<Standard_Size> (aSize) - aHeadLength : 0;
+      if (aDataLength < static_cast<Jt_I32> (sizeof (Jt_U8))
+       || static_cast<Standard_Size> (aDataLength) - sizeof (Jt_U8) > aSegRest)
       {
-        ALARM ("Error: Failed to read compression flags of segment with offset " + theOffset);
+        ALARM ("Error: Invalid compressed data length of segment with offset " + offsetString (theOffset));
         return Handle(JtData_Object)();
       }
 
-      // if compressed, replace the reader by a JtData_Inflate instance
-      if (aFlag == 2 && aAlgorithm == 2)
-        aDataReaderPtr = new JtData_Inflate (aReader, aDataLength - sizeof (Jt_U8));
+      const Standard_Size aCompressedLength = aDataLength - sizeof (Jt_U8);
+      const void* aCompressed = aReader.Load (aCompressedLength);
+
+      aData = new JtData_SegmentCache::RawData();
+      const Standard_Boolean isInflated = aCompressed
+        && JtData_Inflate::InflateBuffer (aCompressed, aCompressedLength, *aData);
+
+      aReader.Unload (aCompressed);
+      if (!isInflated)
+      {
+        ALARM ("Error: Failed to inflate segment with offset " + offsetString (theOffset));
+        return Handle(JtData_Object)();
+      }
     }
   }
 
-  // Read the segment data
+  const Standard_Boolean isCached = !theIsLSG && myCache.IsEnabled();
+  const Standard_Boolean toCacheData =
+    isCached && myCache.CacheMode() == JtData_SegmentCache::Mode_RawData;
+
+  // Load uncompressed segment data to memory if it should be cached
+  if (toCacheData && aData.IsNull())
+  {
+    const Standard_Size aDataEnd = aSegStart + aSize;
+    const Standard_Size aDataPos = aReader.GetPosition();
+
+    aData = new JtData_SegmentCache::RawData();
+    if (aDataEnd < aDataPos
+     || !aData->Allocate (aDataEnd - aDataPos)
+     || !aReader.Read (aData->Data(), aData->Count()))
+    {
+      ALARM ("Error: Failed to read data of segment with offset " + offsetString (theOffset));
+      return Handle(JtData_Object)();
+    }
+  }
+
+  // Read the segment data:
+  // - use the file/mapping reader if the data is not loaded to memory;
+  // - use a reader of the memory buffer otherwise.
   Handle(JtData_Object) aFirstObject;
   Standard_Boolean      aResult;
+  Standard_Size         aDataSize;
 
-  if (theIsLSG)
-    aResult = readLSGData (*aDataReaderPtr, aFirstObject);
+  if (!aData.IsNull())
+  {
+    if (toCacheData)
+      myCache.Add (theOffset, aData);
+
+    JtData_MappedReader aDataReader (aData->Data(), aData->Count(), this);
+    aResult   = readData (aDataReader, theIsLSG, aFirstObject, theSink);
+    aDataSize = aData->Count();
+  }
   else
-    aResult = readElement (*aDataReaderPtr, aFirstObject);
+  {
+    const Standard_Size aDataStart = aReader.GetPosition();
+    aResult   = readData (aReader, theIsLSG, aFirstObject, theSink);
+    aDataSize = aReader.GetPosition() - aDataStart;
+  }
 
-  // Free the JtData_Inflate reader if it was used
-  if (aDataReaderPtr != &aReader)
-    delete aDataReaderPtr;
+  // charge the decoded size of the objects, or the size of their data
+  // for objects giving no estimate
+  if (aResult && isCached && !toCacheData && !aFirstObject.IsNull())
+    myCache.Add (theOffset, aFirstObject, Max (aDataSize, aFirstObject->MemorySize()));
 
   // Check the reading result
   if (!aResult)
@@ -311,6 +452,38 @@ Handle(JtData_Object) JtData_Model::readSegment (std::ifstream&         theFile,
   return aFirstObject;
 }
 
+//=======================================================================
+//function : readSegmentData
+//purpose  : Read an object from cached raw data of a segment
+//=======================================================================
+Handle(JtData_Object) JtData_Model::readSegmentData (const JtData_SegmentCache::RawData& theData,
+                                                     JtElement_ShapeLOD_Sink*            theSink) const
+{
+  JtData_MappedReader aReader (theData.Data(), theData.Count(), this);
+
+  Handle(JtData_Object) anObject;
+  if (!readData (aReader, Standard_False, anObject, theSink))
+  {
+    ALARM ("Error: Segment data reading failed");
+    return Handle(JtData_Object)();
+  }
+
+  return anObject;
+}
+
+//=======================================================================
+//function : readData
+//purpose  : Read LSG or element data of a segment
+//=======================================================================
+Standard_Boolean JtData_Model::readData (JtData_Reader&           theReader,
+                                         const Standard_Boolean   theIsLSG,
+                                         Handle(JtData_Object)&   theFirstObject,
+                                         JtElement_ShapeLOD_Sink* theSink) const
+{
+  return theIsLSG ? readLSGData (theReader, theFirstObject)
+                  : readElement (theReader, theFirstObject, 0L, theSink);
+}
+
 //=======================================================================
 //function : readLSGData
 //purpose  : Read LSG segment data
@@ -457,9 +630,10 @@ Standard_Boolean JtData_Model::readElements (JtData_Reader&               theRea
 //function : readElement
 //purpose  : Read an element from a JT file segment
 //=======================================================================
-Standard_Boolean JtData_Model::readElement (JtData_Reader&         theReader,
-                                            Handle(JtData_Object)& theObject,
-                                            Jt_I32*                theObjectIDPtr) const
+Standard_Boolean JtData_Model::readElement (JtData_Reader&           theReader,
+                                            Handle(JtData_Object)&   theObject,
+                                            Jt_I32*                  theObjectIDPtr,
+                                            JtElement_ShapeLOD_Sink* theSink) const
 {
   // Read Element Length
   Standard_Integer anElemLength;
@@ -526,6 +700,14 @@ Standard_Boolean JtData_Model::readElement (JtData_Reader&         theReader,
       return Standard_False;
   }
 
+  // let a vertex shape LOD pass its decoded mesh data to the sink
+  if (theSink)
+  {
+    Handle(JtElement_ShapeLOD_Vertex) aLOD = Handle(JtElement_ShapeLOD_Vertex)::DownCast (theObject);
+    if (!aLOD.IsNull())
+      aLOD->SetSink (theSink);
+  }
+
   if (!theObject->Read (theReader))
     return Standard_False;
 
@@ -556,12 +738,26 @@ Standard_Boolean JtData_Model::readElement (JtData_Reader&         theReader,
 //purpose  : Lookup offset of a segment in TOCs of this model and its ancestor models
 //=======================================================================
 Handle(JtData_Model) JtData_Model::FindSegment (const Jt_GUID& theGUID,
-                                                      Jt_I32&  theOffset) const
+                                                      Jt_U64&  theOffset) const
+{
+  SegmentInfo anInfo;
+  Handle(JtData_Model) aModel = FindSegment (theGUID, anInfo);
+  if (!aModel.IsNull())
+    theOffset = anInfo.Offset;
+  return aModel;
+}
+
+//=======================================================================
+//function : FindSegment
+//purpose  : Lookup a segment in TOCs of this model and its ancestor models
+//=======================================================================
+Handle(JtData_Model) JtData_Model::FindSegment (const Jt_GUID&     theGUID,
+                                                      SegmentInfo& theInfo) const
 {
-  if (myTOC.Find (theGUID, theOffset))
+  if (myTOC.Find (theGUID, theInfo))
     return this;
   else if (!myParent.IsNull())
-    return myParent->FindSegment (theGUID, theOffset);
+    return myParent->FindSegment (theGUID, theInfo);
   else
   {
     Standard_Character aGuidString[128];
@@ -571,20 +767,133 @@ Handle(JtData_Model) JtData_Model::FindSegment (const Jt_GUID& theGUID,
   }
 }
 
+//=======================================================================
+//function : Prefetch
+//purpose  : Hint the operating system to read the given segments ahead
+//=======================================================================
+void JtData_Model::Prefetch (const NCollection_List<Jt_GUID>& theGUIDs) const
+{
+  // segments separated by less than this gap are requested together
+  static const Jt_U64 MAX_GAP = 65536;
+
+  typedef std::pair<Jt_U64, Jt_U64> Range;
+  std::vector<Range>        aRanges;
+  NCollection_List<Jt_GUID> aParentGUIDs;
+
+  for (NCollection_List<Jt_GUID>::Iterator anIt (theGUIDs); anIt.More(); anIt.Next())
+  {
+    SegmentInfo anInfo;
+    if (myTOC.Find (anIt.Value(), anInfo))
+      aRanges.push_back (Range (anInfo.Offset, anInfo.Offset + anInfo.Length));
+    else
+      aParentGUIDs.Append (anIt.Value());
+  }
+
+  if (!aParentGUIDs.IsEmpty() && !myParent.IsNull())
+    myParent->Prefetch (aParentGUIDs);
+
+  if (aRanges.empty())
+    return;
+
+  // coalesce sorted ranges and issue one request per resulting range
+  std::sort (aRanges.begin(), aRanges.end());
+
+  Range aCurrent = aRanges.front();
+  for (std::vector<Range>::const_iterator aRangeIt = aRanges.begin() + 1;; ++aRangeIt)
+  {
+    if (aRangeIt != aRanges.end() && aRangeIt->first <= aCurrent.second + MAX_GAP)
+    {
+      aCurrent.second = Max (aCurrent.second, aRangeIt->second);
+      continue;
+    }
+
+    if (myMappedFile.IsOpen())
+      myMappedFile.Prefetch (aCurrent.first, aCurrent.second - aCurrent.first);
+    else
+      mySharedFile.Prefetch (aCurrent.first, aCurrent.second - aCurrent.first);
+
+    if (aRangeIt == aRanges.end())
+      break;
+
+    aCurrent = *aRangeIt;
+  }
+}
+
+//=======================================================================
+//function : LoadSegments
+//purpose  : Load segments of the given late loaded properties in parallel
+//=======================================================================
+void JtData_Model::LoadSegments (const JtData_Object::ListOfLateLoads& theLateLoads,
+                                 LoadCallback*                         theCallback,
+                                 JtElement_ShapeLOD_Sink*              theSink)
+{
+  // request read-ahead of all segments grouped by their models
+  typedef std::map<const JtData_Model*, NCollection_List<Jt_GUID> > ModelSegments;
+  ModelSegments aSegments;
+  for (JtData_Object::ListOfLateLoads::Iterator anIt (theLateLoads); anIt.More(); anIt.Next())
+  {
+    const Handle(JtData_Model)& aModel = anIt.Value()->SegmentModel();
+    if (!aModel.IsNull())
+      aSegments[aModel.operator->()].Append (anIt.Value()->SegmentGUID());
+  }
+
+  for (ModelSegments::const_iterator aModelIt = aSegments.begin(); aModelIt != aSegments.end(); ++aModelIt)
+    aModelIt->first->Prefetch (aModelIt->second);
+
+  // read, inflate and decode the segments
+  JtData_Parallel::TaskGroup aLoadTasks;
+  for (JtData_Object::ListOfLateLoads::Iterator anIt (theLateLoads); anIt.More(); anIt.Next())
+  {
+    if (!anIt.Value()->SegmentModel().IsNull())
+      aLoadTasks.Run (JtData_Model_LoadSegmentTask (anIt.Value(), theCallback, theSink));
+    else if (theCallback)
+      theCallback->SegmentLoaded (anIt.Value());
+  }
+
+  aLoadTasks.Wait();
+}
+
 //=======================================================================
 //function : ReadSegment
 //purpose  : Read object from a late loaded segment
 //=======================================================================
-Handle(JtData_Object) JtData_Model::ReadSegment (const Jt_I32 theOffset) const
+Handle(JtData_Object) JtData_Model::ReadSegment (const Jt_U64             theOffset,
+                                                 JtElement_ShapeLOD_Sink* theSink) const
 {
-  ifstream aFile;
-  if (!open (aFile))
+  if (!myMappedFile.IsOpen() && !mySharedFile.IsOpen())
   {
-    ALARM ("Error: Failed to open Jt file of late-loaded segment");
-    return Handle(JtNode_Partition)();
+    ALARM ("Error: Jt file of late-loaded segment is not open");
+    return Handle(JtData_Object)();
+  }
+
+  // cached objects keep their data, so they are read again to feed a sink
+  if (myCache.IsEnabled())
+  {
+    if (myCache.CacheMode() == JtData_SegmentCache::Mode_Objects)
+    {
+      Handle(JtData_Object) anObject;
+      if (!theSink && myCache.Find (theOffset, anObject))
+        return anObject;
+    }
+    else
+    {
+      NCollection_Handle<JtData_SegmentCache::RawData> aData;
+      if (myCache.Find (theOffset, aData))
+        return readSegmentData (*aData, theSink);
+    }
   }
 
-  return readSegment (aFile, theOffset, Standard_False);
+  return readSegment (theOffset, Standard_False, theSink);
+}
+
+//=======================================================================
+//function : SetSegmentCache
+//purpose  : Enable caching of late loaded segments
+//=======================================================================
+void JtData_Model::SetSegmentCache (const Standard_Size             theBudget,
+                                    const JtData_SegmentCache::Mode theMode)
+{
+  myCache.SetBudget (theBudget, theMode);
 }
 
 //=======================================================================
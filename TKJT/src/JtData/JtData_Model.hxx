@@ -19,16 +19,21 @@
 
 #include <JtData_Types.hxx>
 #include <JtData_Object.hxx>
+#include <JtData_MappedFile.hxx>
+#include <JtData_SharedFile.hxx>
+#include <JtData_SegmentCache.hxx>
 
 #include <TCollection_ExtendedString.hxx>
 
 #include <Standard_DefineHandle.hxx>
 #include <Standard_OStream.hxx>
 #include <NCollection_DataMap.hxx>
+#include <NCollection_List.hxx>
 
 #include <fstream>
 
 class Handle(JtNode_Partition);
+class JtElement_ShapeLOD_Sink;
 
 DEFINE_STANDARD_HANDLE(JtData_Model, MMgt_TShared)
 
@@ -39,6 +44,29 @@ class JtData_Model : public MMgt_TShared
 public:
   static const Standard_Boolean IsLittleEndianHost;
 
+  //! Table of contents entry describing a segment of the file.
+  struct SegmentInfo
+  {
+    Jt_U64           Offset;         //!< Absolute offset of the segment header
+    Jt_U32           Length;         //!< Segment length including the header
+    Standard_Integer Type;           //!< Segment type
+    Standard_Boolean IsCompressible; //!< Segment data of this type may be ZLIB compressed
+  };
+
+  typedef NCollection_DataMap<Jt_GUID, SegmentInfo, Jt_GUID> SegmentMap;
+
+  //! Interface of a receiver of late loaded properties processed by LoadSegments().
+  class LoadCallback
+  {
+  public:
+    virtual ~LoadCallback() {}
+
+    //! Called when the segment of the property has been loaded (or failed to load,
+    //! in this case the deferred object of the property is null).
+    //! Can be called concurrently from different threads.
+    virtual void SegmentLoaded (const Handle(JtProperty_LateLoaded)& theProperty) = 0;
+  };
+
 public:
   //! Constructor initializing model by specified file
   //! @param theFileName - name of Jt file
@@ -51,10 +79,44 @@ public:
 
   //! Lookup offset of a segment in TOCs of this model and its ancestor models.
   Standard_EXPORT Handle(JtData_Model) FindSegment (const Jt_GUID& theGUID,
-                                                          Jt_I32&  theOffset) const;
+                                                          Jt_U64&  theOffset) const;
+
+  //! Lookup a segment in TOCs of this model and its ancestor models.
+  Standard_EXPORT Handle(JtData_Model) FindSegment (const Jt_GUID&     theGUID,
+                                                          SegmentInfo& theInfo) const;
+
+  //! Return the table of contents of this model.
+  const SegmentMap& Segments() const { return myTOC; }
+
+  //! Hint the operating system to read the given segments ahead of their decoding.
+  //! Segments are sorted by offset and neighbouring ones are requested as one range;
+  //! segments from ancestor models are passed to these models.
+  Standard_EXPORT void Prefetch (const NCollection_List<Jt_GUID>& theGUIDs) const;
+
+  //! Load segments of the given late loaded properties in parallel.
+  //! The properties may refer to segments of different models.
+  //! Decoded mesh data is written to buffers of the given sink if any,
+  //! requested concurrently from the loading threads (see ReadSegment()).
+  //! Returns when all segments are loaded.
+  Standard_EXPORT static void LoadSegments (const JtData_Object::ListOfLateLoads& theLateLoads,
+                                            LoadCallback*                         theCallback = 0L,
+                                            JtElement_ShapeLOD_Sink*              theSink     = 0L);
+
+  //! Enable caching of late loaded segments with the given byte budget
+  //! (0 disables the cache). The cache keeps either decoded objects or inflated data.
+  Standard_EXPORT void SetSegmentCache (const Standard_Size             theBudget,
+                                        const JtData_SegmentCache::Mode theMode = JtData_SegmentCache::Mode_Objects);
+
+  //! Return cache usage counters.
+  JtData_SegmentCache::Statistics SegmentCacheStatistics() const { return myCache.GetStatistics(); }
 
   //! Read object from a late loaded segment.
-  Standard_EXPORT Handle(JtData_Object) ReadSegment (const Jt_I32 theOffset) const;
+  //! Thread-safe: the file is shared by all callers without reopening it.
+  //! If a sink is given, decoded mesh data of vertex shape LODs is written to
+  //! the buffers it provides instead of being kept in the elements, and cached
+  //! objects are not used.
+  Standard_EXPORT Handle(JtData_Object) ReadSegment (const Jt_U64             theOffset,
+                                                     JtElement_ShapeLOD_Sink* theSink = 0L) const;
 
   //! Dump this entity.
   Standard_EXPORT Standard_Integer Dump (Standard_OStream& theStream) const;
@@ -74,16 +136,33 @@ public:
   DEFINE_STANDARD_RTTI(JtData_Model)
 
 protected:
-  //! Open the file.
-  Standard_Boolean open (std::ifstream& aFile) const;
+  //! Create a reader starting at the given offset: a reader of the file mapping
+  //! if the file is mapped or a pooled positional file reader otherwise.
+  JtData_Reader* newReader (const Jt_U64 theOffset) const;
+
+  //! Check if data of segments of the given type may be compressed.
+  static Standard_Boolean isCompressible (const Standard_Integer theType);
+
+  //! Read a file offset stored in the format of the file version.
+  Standard_Boolean readOffset (JtData_Reader& theReader, Jt_U64& theOffset) const;
 
   //! Read TOC from the JT file.
-  Standard_Boolean readTOC (std::ifstream& theFile, const Jt_I32 theOffset);
+  Standard_Boolean readTOC (const Jt_U64 theOffset);
 
   //! Read object(s) from a JT file segment.
-  Handle(JtData_Object) readSegment (std::ifstream&           theFile,
-                                     const Jt_I32             theOffset,
-                                     const Standard_Boolean   theIsLSG) const;
+  Handle(JtData_Object) readSegment (const Jt_U64             theOffset,
+                                     const Standard_Boolean   theIsLSG,
+                                     JtElement_ShapeLOD_Sink* theSink = 0L) const;
+
+  //! Read an object from cached raw data of a segment.
+  Handle(JtData_Object) readSegmentData (const JtData_SegmentCache::RawData& theData,
+                                         JtElement_ShapeLOD_Sink*            theSink) const;
+  //! Read LSG or element data of a segment.
+  Standard_Boolean readData     (JtData_Reader&               theReader,
+                                 const Standard_Boolean       theIsLSG,
+                                 Handle(JtData_Object)&       theFirstObject,
+                                 JtElement_ShapeLOD_Sink*     theSink = 0L) const;
+
   //! Read LSG segment data.
   Standard_Boolean readLSGData  (JtData_Reader&               theReader,
                                  Handle(JtData_Object)&       theFirstObject) const;
@@ -94,9 +173,11 @@ protected:
                                  Handle(JtData_Object)&       theFirstObject) const;
 
   //! Read an element from a JT file segment.
+  //! Decoded mesh data of a vertex shape LOD is passed to the given sink if any.
   Standard_Boolean readElement  (JtData_Reader&               theReader,
                                  Handle(JtData_Object)&       theObject,
-                                 Jt_I32*                      theObjectIDPtr = 0L) const;
+                                 Jt_I32*                      theObjectIDPtr = 0L,
+                                 JtElement_ShapeLOD_Sink*     theSink        = 0L) const;
 
 protected:
   Handle(JtData_Model)       myParent;
@@ -107,7 +188,12 @@ protected:
   Standard_Integer           myMajorVersion;
   Standard_Integer           myMinorVersion;
 
-  NCollection_DataMap <Jt_GUID, Jt_I32, Jt_GUID> myTOC;
+  SegmentMap                 myTOC;
+
+  JtData_MappedFile          myMappedFile;
+  JtData_SharedFile          mySharedFile;
+
+  mutable JtData_SegmentCache myCache;
 };
 
 #endif // _JtData_Model_HeaderFile
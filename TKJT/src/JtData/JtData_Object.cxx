@@ -61,3 +61,21 @@ void JtData_Object::BindLateLoads (const ListOfLateLoads&)
 void JtData_Object::BindName (const TCollection_ExtendedString&)
 {
 }
+
+//=======================================================================
+//function : MemorySize
+//purpose  : Return estimated size of the decoded data of the object
+//=======================================================================
+Standard_Size JtData_Object::MemorySize() const
+{
+  return 0;
+}
+
+//=======================================================================
+//function : IsCacheable
+//purpose  : Return true if the object may be shared by a cache
+//=======================================================================
+Standard_Boolean JtData_Object::IsCacheable() const
+{
+  return Standard_True;
+}
@@ -62,6 +62,14 @@ public:
   //! Bind a name to the object.
   Standard_EXPORT virtual void BindName (const TCollection_ExtendedString& theName);
 
+  //! Return estimated size of the decoded data of the object in bytes;
+  //! 0 if the object gives no estimate.
+  Standard_EXPORT virtual Standard_Size MemorySize() const;
+
+  //! Return true if the object keeps its decoded data after reading,
+  //! so that it may be shared by a cache of decoded objects.
+  Standard_EXPORT virtual Standard_Boolean IsCacheable() const;
+
   DEFINE_STANDARD_RTTI(JtData_Object)
 };
 
@@ -26,16 +26,54 @@
 #include <tbb/parallel_for.h>
 #endif
 
+#include <JtData_Arena.hxx>
+
+//! Storage class specifier of thread-local variables.
+#ifdef _MSC_VER
+  #define JT_THREAD_LOCAL __declspec(thread)
+#else
+  #define JT_THREAD_LOCAL __thread
+#endif
+
 //! Wrappers for TBB interface providing an option to disable multithreading
 //! by defining NO_JT_MULTITHREADING symbol and some enhancements.
 namespace JtData_Parallel
 {
+#ifndef NO_JT_MULTITHREADING
+  //! Task wrapper running the task with the decoding arena that was current
+  //! for the thread creating it. A thread waiting for its tasks may execute
+  //! unrelated ones (e.g. other segments being loaded); these should neither
+  //! allocate from nor outlive the arena of the waiting thread.
+  template <typename F>
+  class ArenaTask
+  {
+  public:
+    explicit ArenaTask (const F& theTask) : myTask (theTask), myArena (JtData_Arena::Current()) {}
+
+    void operator()() const
+    {
+      JtData_Arena::Scope anArenaScope (myArena);
+      myTask();
+    }
+
+    template <typename Index> void operator() (Index theIndex) const
+    {
+      JtData_Arena::Scope anArenaScope (myArena);
+      myTask (theIndex);
+    }
+
+  private:
+    F             myTask;
+    JtData_Arena* myArena;
+  };
+#endif
+
   //! A wrapper for tbb::task_group class providing correct destruction.
 #ifndef NO_JT_MULTITHREADING
   class TaskGroup
   {
   public:
-    template <typename F> void Run (const F& theTask) { myTBBGroup.run (theTask); }
+    template <typename F> void Run (const F& theTask) { myTBBGroup.run (ArenaTask<F> (theTask)); }
     void Wait() { myTBBGroup.wait(); }
 
     ~TaskGroup()
@@ -61,7 +99,7 @@ namespace JtData_Parallel
   void For (Index theFirst, Index theLast, const F& theTask)
   {
 #ifndef NO_JT_MULTITHREADING
-    tbb::parallel_for (theFirst, theLast, theTask);
+    tbb::parallel_for (theFirst, theLast, ArenaTask<F> (theTask));
 #else
     for (Index i = theFirst; i < theLast; i++)
       theTask (i);
@@ -0,0 +1,107 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include <JtData_PooledReader.hxx>
+
+#include <cstring>
+
+//=======================================================================
+//function : JtData_PooledReader
+//purpose  : Constructor
+//=======================================================================
+
+JtData_PooledReader::JtData_PooledReader (const JtData_SharedFile&    theFile,
+                                          const Handle(JtData_Model)& theModel,
+                                          const uint64_t              theOffset)
+  : JtData_Reader (theModel)
+  , myFile        (&theFile)
+  , myBuffer      (theFile.AcquireBuffer())
+  , myBufStart    (theOffset)
+  , myBufLength   (0)
+  , myPos         (theOffset) {}
+
+//=======================================================================
+//function : ~JtData_PooledReader
+//purpose  : Destructor
+//=======================================================================
+
+JtData_PooledReader::~JtData_PooledReader()
+{
+  myFile->ReleaseBuffer (myBuffer);
+}
+
+//=======================================================================
+//function : ReadBytes
+//purpose  : Read raw bytes from the file
+//=======================================================================
+
+Standard_Boolean JtData_PooledReader::ReadBytes (void* theBuffer, Standard_Size theLength)
+{
+  uint8_t* aTarget = static_cast<uint8_t*> (theBuffer);
+
+  while (theLength > 0)
+  {
+    // copy the part available in the buffer
+    if (myPos >= myBufStart && myPos < myBufStart + myBufLength)
+    {
+      const Standard_Size anOffset = static_cast<Standard_Size> (myPos - myBufStart);
+      const Standard_Size aCount   = Min (theLength, myBufLength - anOffset);
+      memcpy (aTarget, myBuffer + anOffset, aCount);
+      aTarget   += aCount;
+      theLength -= aCount;
+      myPos     += aCount;
+      continue;
+    }
+
+    // read large blocks directly to the target
+    if (theLength >= JtData_SharedFile::BufferSize || !myBuffer)
+    {
+      const Standard_Size aRead = myFile->ReadAt (aTarget, theLength, myPos);
+      myPos += aRead;
+      return aRead == theLength;
+    }
+
+    // refill the buffer
+    myBufStart  = myPos;
+    myBufLength = myFile->ReadAt (myBuffer, JtData_SharedFile::BufferSize, myPos);
+    if (myBufLength == 0)
+      return Standard_False;
+  }
+
+  return Standard_True;
+}
+
+//=======================================================================
+//function : SkipBytes
+//purpose  : Skip some bytes
+//=======================================================================
+
+Standard_Boolean JtData_PooledReader::SkipBytes (Standard_Size theLength)
+{
+  myPos += theLength;
+  return Standard_True;
+}
+
+//=======================================================================
+//function : GetPosition
+//purpose  : Get absolute reading position
+//=======================================================================
+
+Standard_Size JtData_PooledReader::GetPosition() const
+{
+  return static_cast<Standard_Size> (myPos);
+}
@@ -0,0 +1,57 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef _JtData_PooledReader_HeaderFile
+#define _JtData_PooledReader_HeaderFile
+
+#include <JtData_Reader.hxx>
+#include <JtData_SharedFile.hxx>
+
+//! Buffered positional reader of a file opened by JtData_SharedFile.
+//! Each reader keeps its own 64-bit position, so several readers
+//! of the same file may be used concurrently.
+//! GetPosition() returns the position truncated to Standard_Size,
+//! which is only used for distances within a segment.
+class JtData_PooledReader : public JtData_Reader
+{
+public:
+  //! Constructor.
+  Standard_EXPORT JtData_PooledReader (const JtData_SharedFile&    theFile,
+                                       const Handle(JtData_Model)& theModel,
+                                       const uint64_t              theOffset = 0);
+
+  //! Destructor; returns the buffer to the pool.
+  Standard_EXPORT virtual ~JtData_PooledReader();
+
+  //! Read raw bytes from the file.
+  Standard_EXPORT virtual Standard_Boolean ReadBytes (void* theBuffer, Standard_Size theLength);
+
+  //! Skip some bytes.
+  Standard_EXPORT virtual Standard_Boolean SkipBytes (Standard_Size theLength);
+
+  //! Get absolute reading position.
+  Standard_EXPORT virtual Standard_Size GetPosition() const;
+
+protected:
+  const JtData_SharedFile* myFile;
+  uint8_t*                 myBuffer;
+  uint64_t                 myBufStart;
+  Standard_Size            myBufLength;
+  uint64_t                 myPos;
+};
+
+#endif // _JtData_PooledReader_HeaderFile
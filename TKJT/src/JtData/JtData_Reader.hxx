@@ -107,10 +107,10 @@ public:
 
   //! Load/map raw bytes from the stream to memory
   //! and return a pointer to access the data.
-  const void* LoadBytes (const Standard_Size theLength);
+  Standard_EXPORT virtual const void* LoadBytes (const Standard_Size theLength);
 
   //! Free/unmap memory allocated/mapped by the Load method.
-  void UnloadBytes (const void* theAddress);
+  Standard_EXPORT virtual void UnloadBytes (const void* theAddress);
 
   //! Read a 1-byte character string.
   Standard_Boolean ReadSbString (TCollection_AsciiString& theString);
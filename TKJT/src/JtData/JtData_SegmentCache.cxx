@@ -0,0 +1,264 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include <JtData_SegmentCache.hxx>
+
+//=======================================================================
+//function : JtData_SegmentCache
+//purpose  : Constructor
+//=======================================================================
+
+JtData_SegmentCache::JtData_SegmentCache()
+: myBudget (0)
+, myBytes  (0)
+, myMode   (Mode_Objects)
+{
+  myStats.Hits = myStats.Misses = myStats.Evictions = myStats.Entries = myStats.Bytes = 0;
+}
+
+//=======================================================================
+//function : SetBudget
+//purpose  : Set the byte budget and the mode
+//=======================================================================
+
+void JtData_SegmentCache::SetBudget (const Standard_Size theBudget, const Mode theMode)
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  if (theMode != myMode)
+  {
+    myEntries.clear();
+    myMap.clear();
+    myBytes = 0;
+  }
+
+  myBudget = theBudget;
+  myMode   = theMode;
+  evict (myBudget);
+}
+
+//=======================================================================
+//function : Budget
+//purpose  : Return the byte budget
+//=======================================================================
+
+Standard_Size JtData_SegmentCache::Budget() const
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+  return myBudget;
+}
+
+//=======================================================================
+//function : CacheMode
+//purpose  : Return the mode
+//=======================================================================
+
+JtData_SegmentCache::Mode JtData_SegmentCache::CacheMode() const
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+  return myMode;
+}
+
+//=======================================================================
+//function : IsEnabled
+//purpose  : Return true if the cache is enabled
+//=======================================================================
+
+Standard_Boolean JtData_SegmentCache::IsEnabled() const
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+  return myBudget > 0;
+}
+
+//=======================================================================
+//function : Find
+//purpose  : Find decoded objects of the segment
+//=======================================================================
+
+Standard_Boolean JtData_SegmentCache::Find (const Jt_U64           theOffset,
+                                            Handle(JtData_Object)& theObject)
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  EntryList::iterator anEntry;
+  if (myMode != Mode_Objects || !touch (theOffset, anEntry))
+    return Standard_False;
+
+  theObject = anEntry->Object;
+  return Standard_True;
+}
+
+//=======================================================================
+//function : Find
+//purpose  : Find raw data of the segment
+//=======================================================================
+
+Standard_Boolean JtData_SegmentCache::Find (const Jt_U64                 theOffset,
+                                            NCollection_Handle<RawData>& theData)
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  EntryList::iterator anEntry;
+  if (myMode != Mode_RawData || !touch (theOffset, anEntry))
+    return Standard_False;
+
+  theData = anEntry->Data;
+  return Standard_True;
+}
+
+//=======================================================================
+//function : Add
+//purpose  : Store decoded objects of the segment
+//=======================================================================
+
+void JtData_SegmentCache::Add (const Jt_U64                 theOffset,
+                               const Handle(JtData_Object)& theObject,
+                               const Standard_Size          theCost)
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+  if (myMode != Mode_Objects || theObject.IsNull() || !theObject->IsCacheable())
+    return;
+
+  Entry anEntry;
+  anEntry.Offset = theOffset;
+  anEntry.Object = theObject;
+  anEntry.Cost   = theCost;
+  add (anEntry);
+}
+
+//=======================================================================
+//function : Add
+//purpose  : Store raw data of the segment
+//=======================================================================
+
+void JtData_SegmentCache::Add (const Jt_U64                       theOffset,
+                               const NCollection_Handle<RawData>& theData)
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+  if (myMode != Mode_RawData || theData.IsNull())
+    return;
+
+  Entry anEntry;
+  anEntry.Offset = theOffset;
+  anEntry.Data   = theData;
+  anEntry.Cost   = theData->Count();
+  add (anEntry);
+}
+
+//=======================================================================
+//function : Clear
+//purpose  : Remove all entries
+//=======================================================================
+
+void JtData_SegmentCache::Clear()
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  myEntries.clear();
+  myMap.clear();
+  myBytes = 0;
+}
+
+//=======================================================================
+//function : GetStatistics
+//purpose  : Return usage counters
+//=======================================================================
+
+JtData_SegmentCache::Statistics JtData_SegmentCache::GetStatistics() const
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  Statistics aStats = myStats;
+  aStats.Entries = myMap.size();
+  aStats.Bytes   = myBytes;
+  return aStats;
+}
+
+//=======================================================================
+//function : ResetStatistics
+//purpose  : Reset hit, miss and eviction counters
+//=======================================================================
+
+void JtData_SegmentCache::ResetStatistics()
+{
+  Standard_Mutex::Sentry aSentry (myMutex);
+
+  myStats.Hits = myStats.Misses = myStats.Evictions = 0;
+}
+
+//=======================================================================
+//function : touch
+//purpose  : Find an entry and move it to the front of the list
+//=======================================================================
+
+Standard_Boolean JtData_SegmentCache::touch (const Jt_U64 theOffset, EntryList::iterator& theEntry)
+{
+  EntryMap::iterator aMapIt = myMap.find (theOffset);
+  if (aMapIt == myMap.end())
+  {
+    myStats.Misses++;
+    return Standard_False;
+  }
+
+  myStats.Hits++;
+  theEntry = aMapIt->second;
+  myEntries.splice (myEntries.begin(), myEntries, theEntry);
+  return Standard_True;
+}
+
+//=======================================================================
+//function : add
+//purpose  : Add an entry and evict the least recently used ones
+//=======================================================================
+
+void JtData_SegmentCache::add (const Entry& theEntry)
+{
+  // do not flush the whole cache for an entry that never fits
+  if (theEntry.Cost > myBudget)
+    return;
+
+  EntryMap::iterator aMapIt = myMap.find (theEntry.Offset);
+  if (aMapIt != myMap.end())
+  {
+    myBytes -= aMapIt->second->Cost;
+    myEntries.erase (aMapIt->second);
+    myMap.erase (aMapIt);
+  }
+
+  evict (myBudget - theEntry.Cost);
+
+  myEntries.push_front (theEntry);
+  myMap[theEntry.Offset] = myEntries.begin();
+  myBytes += theEntry.Cost;
+}
+
+//=======================================================================
+//function : evict
+//purpose  : Evict the least recently used entries exceeding the budget
+//=======================================================================
+
+void JtData_SegmentCache::evict (const Standard_Size theBudget)
+{
+  while (myBytes > theBudget && !myEntries.empty())
+  {
+    const Entry& anEntry = myEntries.back();
+    myBytes -= anEntry.Cost;
+    myMap.erase (anEntry.Offset);
+    myEntries.pop_back();
+    myStats.Evictions++;
+  }
+}
@@ -0,0 +1,138 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef _JtData_SegmentCache_HeaderFile
+#define _JtData_SegmentCache_HeaderFile
+
+#include <JtData_Object.hxx>
+#include <JtData_Types.hxx>
+
+#include <Standard_Mutex.hxx>
+#include <NCollection_Handle.hxx>
+
+#include <list>
+#include <map>
+
+//! Least recently used cache of late loaded segments with a byte budget.
+//! Depending on the mode, it keeps either decoded objects of the segments
+//! or their raw (inflated) data. Thread-safe.
+//!
+//! Cached objects are returned to every reader of the segment, so they
+//! must not be modified: objects that give their data away on reading
+//! (see JtData_Object::IsCacheable()) are not cached, and in-place
+//! processing like JtElement_ShapeLOD_Vertex::OptimizeVertexCache()
+//! requires the objects to be read with the cache of objects disabled
+//! (or in raw data mode).
+class JtData_SegmentCache
+{
+public:
+  //! Kind of cached segment contents.
+  enum Mode
+  {
+    Mode_Objects, //!< decoded objects; a hit costs a lookup only
+    Mode_RawData  //!< inflated segment data; a hit saves reading and inflating
+  };
+
+  //! Raw segment data.
+  typedef JtData_Vector<Jt_U8> RawData;
+
+  //! Cache usage counters.
+  struct Statistics
+  {
+    Standard_Size Hits;      //!< Number of successful lookups
+    Standard_Size Misses;    //!< Number of failed lookups
+    Standard_Size Evictions; //!< Number of entries removed to fit the budget
+    Standard_Size Entries;   //!< Number of cached entries
+    Standard_Size Bytes;     //!< Total size of cached entries
+  };
+
+public:
+  //! Constructor of a disabled cache.
+  Standard_EXPORT JtData_SegmentCache();
+
+  //! Set the byte budget (0 disables the cache) and the mode.
+  //! Entries exceeding the new budget are evicted;
+  //! all entries are dropped if the mode changes.
+  Standard_EXPORT void SetBudget (const Standard_Size theBudget, const Mode theMode);
+
+  //! Return the byte budget.
+  Standard_EXPORT Standard_Size Budget() const;
+
+  //! Return the mode.
+  Standard_EXPORT Mode CacheMode() const;
+
+  //! Return true if the cache is enabled.
+  Standard_EXPORT Standard_Boolean IsEnabled() const;
+
+  //! Find decoded objects of the segment at the given offset.
+  Standard_EXPORT Standard_Boolean Find (const Jt_U64 theOffset, Handle(JtData_Object)& theObject);
+
+  //! Find raw data of the segment at the given offset.
+  Standard_EXPORT Standard_Boolean Find (const Jt_U64 theOffset, NCollection_Handle<RawData>& theData);
+
+  //! Store decoded objects of the segment; theCost is the estimated size
+  //! of their decoded data in bytes. Objects that are not cacheable are ignored.
+  Standard_EXPORT void Add (const Jt_U64                 theOffset,
+                            const Handle(JtData_Object)& theObject,
+                            const Standard_Size          theCost);
+
+  //! Store raw data of the segment.
+  Standard_EXPORT void Add (const Jt_U64                       theOffset,
+                            const NCollection_Handle<RawData>& theData);
+
+  //! Remove all entries.
+  Standard_EXPORT void Clear();
+
+  //! Return usage counters.
+  Standard_EXPORT Statistics GetStatistics() const;
+
+  //! Reset hit, miss and eviction counters.
+  Standard_EXPORT void ResetStatistics();
+
+private:
+  //! Cached segment contents.
+  struct Entry
+  {
+    Jt_U64                      Offset;
+    Handle(JtData_Object)       Object;
+    NCollection_Handle<RawData> Data;
+    Standard_Size               Cost;
+  };
+
+  typedef std::list<Entry>                           EntryList;
+  typedef std::map<Jt_U64, EntryList::iterator>      EntryMap;
+
+  //! Find an entry and move it to the front of the list.
+  Standard_Boolean touch (const Jt_U64 theOffset, EntryList::iterator& theEntry);
+
+  //! Add an entry and evict the least recently used ones exceeding the budget.
+  void add (const Entry& theEntry);
+
+  //! Evict the least recently used entries until the cached size fits the budget.
+  void evict (const Standard_Size theBudget);
+
+private:
+  EntryList              myEntries; //!< entries, the most recently used first
+  EntryMap               myMap;
+  Standard_Size          myBudget;
+  Standard_Size          myBytes;
+  Mode                   myMode;
+  Statistics             myStats;
+  mutable Standard_Mutex myMutex;
+};
+
+#endif // _JtData_SegmentCache_HeaderFile
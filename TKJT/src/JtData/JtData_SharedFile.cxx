@@ -0,0 +1,218 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+// 64-bit file offsets for pread() and posix_fadvise() on 32-bit systems
+#ifndef _FILE_OFFSET_BITS
+  #define _FILE_OFFSET_BITS 64
+#endif
+
+#include <JtData_SharedFile.hxx>
+
+#include <TCollection_AsciiString.hxx>
+
+#ifdef WNT
+  #include <windows.h>
+#else
+  #include <sys/types.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <errno.h>
+#endif
+
+//=======================================================================
+//function : JtData_SharedFile
+//purpose  : Constructor
+//=======================================================================
+
+JtData_SharedFile::JtData_SharedFile()
+#ifdef WNT
+: myFileHandle (INVALID_HANDLE_VALUE)
+#else
+: myFileHandle (-1)
+#endif
+{}
+
+//=======================================================================
+//function : ~JtData_SharedFile
+//purpose  : Destructor
+//=======================================================================
+
+JtData_SharedFile::~JtData_SharedFile()
+{
+  Close();
+
+  for (NCollection_List<uint8_t*>::Iterator anIt (myFreeBuffers); anIt.More(); anIt.Next())
+    Standard::Free (reinterpret_cast<Standard_Address&> (anIt.ChangeValue()));
+}
+
+//=======================================================================
+//function : Open
+//purpose  : Open the file with the given name for reading
+//=======================================================================
+
+Standard_Boolean JtData_SharedFile::Open (const TCollection_ExtendedString& theFileName)
+{
+  Close();
+
+#ifdef WNT
+  myFileHandle = CreateFileW (reinterpret_cast<const wchar_t*> (theFileName.ToExtString()),
+                              GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+#else
+  TCollection_AsciiString anAsciiName (theFileName, ' ');
+  myFileHandle = open (anAsciiName.ToCString(), O_RDONLY);
+#endif
+
+  return IsOpen();
+}
+
+//=======================================================================
+//function : Close
+//purpose  : Close the file
+//=======================================================================
+
+void JtData_SharedFile::Close()
+{
+  if (!IsOpen())
+    return;
+
+#ifdef WNT
+  CloseHandle (myFileHandle);
+  myFileHandle = INVALID_HANDLE_VALUE;
+#else
+  close (myFileHandle);
+  myFileHandle = -1;
+#endif
+}
+
+//=======================================================================
+//function : IsOpen
+//purpose  : Return true if the file is open
+//=======================================================================
+
+Standard_Boolean JtData_SharedFile::IsOpen() const
+{
+#ifdef WNT
+  return myFileHandle != INVALID_HANDLE_VALUE;
+#else
+  return myFileHandle >= 0;
+#endif
+}
+
+//=======================================================================
+//function : ReadAt
+//purpose  : Read bytes starting at the given absolute offset
+//=======================================================================
+
+Standard_Size JtData_SharedFile::ReadAt (void*               theBuffer,
+                                       const Standard_Size theLength,
+                                       const uint64_t      theOffset) const
+{
+  uint8_t* aBuffer = static_cast<uint8_t*> (theBuffer);
+  Standard_Size  aRead   = 0;
+
+  while (aRead < theLength)
+  {
+    const uint64_t anOffset = theOffset + aRead;
+
+#ifdef WNT
+    const Standard_Size aChunk = Min (theLength - aRead, static_cast<Standard_Size> (0x40000000));
+
+    OVERLAPPED anOverlapped = {};
+    anOverlapped.Offset     = static_cast<DWORD> (anOffset);
+    anOverlapped.OffsetHigh = static_cast<DWORD> (anOffset >> 32);
+
+    DWORD aDone = 0;
+    if (!ReadFile (myFileHandle, aBuffer + aRead, static_cast<DWORD> (aChunk), &aDone, &anOverlapped)
+     || aDone == 0)
+    {
+      break;
+    }
+#else
+    const ssize_t aDone = pread (myFileHandle, aBuffer + aRead, theLength - aRead,
+                                 static_cast<off_t> (anOffset));
+    if (aDone < 0 && errno == EINTR)
+      continue;
+    if (aDone <= 0)
+      break;
+#endif
+
+    aRead += static_cast<Standard_Size> (aDone);
+  }
+
+  return aRead;
+}
+
+//=======================================================================
+//function : Prefetch
+//purpose  : Hint the system to read the given range of the file ahead
+//=======================================================================
+
+void JtData_SharedFile::Prefetch (const uint64_t theOffset, const uint64_t theLength) const
+{
+  if (!IsOpen())
+    return;
+
+#ifdef WNT
+  // no read-ahead hint for handles on Windows; warm the system cache by reading the range
+  uint8_t* aBuffer = AcquireBuffer();
+  for (uint64_t aPos = 0; aPos < theLength; aPos += BufferSize)
+  {
+    const uint64_t aChunk = Min (theLength - aPos, static_cast<uint64_t> (BufferSize));
+    if (ReadAt (aBuffer, static_cast<Standard_Size> (aChunk), theOffset + aPos) == 0)
+      break;
+  }
+  ReleaseBuffer (aBuffer);
+#else
+  posix_fadvise (myFileHandle, static_cast<off_t> (theOffset),
+                 static_cast<off_t> (theLength), POSIX_FADV_WILLNEED);
+#endif
+}
+
+//=======================================================================
+//function : AcquireBuffer
+//purpose  : Take a buffer from the pool
+//=======================================================================
+
+uint8_t* JtData_SharedFile::AcquireBuffer() const
+{
+  {
+    Standard_Mutex::Sentry aSentry (myMutex);
+    if (!myFreeBuffers.IsEmpty())
+    {
+      uint8_t* aBuffer = myFreeBuffers.First();
+      myFreeBuffers.RemoveFirst();
+      return aBuffer;
+    }
+  }
+
+  return static_cast<uint8_t*> (Standard::Allocate (BufferSize));
+}
+
+//=======================================================================
+//function : ReleaseBuffer
+//purpose  : Return a buffer to the pool
+//=======================================================================
+
+void JtData_SharedFile::ReleaseBuffer (uint8_t* theBuffer) const
+{
+  if (!theBuffer)
+    return;
+
+  Standard_Mutex::Sentry aSentry (myMutex);
+  myFreeBuffers.Prepend (theBuffer);
+}
@@ -0,0 +1,86 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef _JtData_SharedFile_HeaderFile
+#define _JtData_SharedFile_HeaderFile
+
+#include <Standard.hxx>
+#include <Standard_Mutex.hxx>
+#include <TCollection_ExtendedString.hxx>
+#include <NCollection_List.hxx>
+
+//! File opened once with a single descriptor shared for positional
+//! (pread-style) reading, plus a pool of read buffers for the readers.
+//! There is no shared seek state, so any number of threads
+//! may read the file simultaneously.
+class JtData_SharedFile
+{
+public:
+  //! Size of a pooled read buffer.
+  static const Standard_Size BufferSize = 65536;
+
+public:
+  //! Constructor.
+  Standard_EXPORT JtData_SharedFile();
+
+  //! Destructor; closes the file and frees the buffers.
+  Standard_EXPORT ~JtData_SharedFile();
+
+  //! Open the file with the given name for reading.
+  Standard_EXPORT Standard_Boolean Open (const TCollection_ExtendedString& theFileName);
+
+  //! Close the file.
+  Standard_EXPORT void Close();
+
+  //! Return true if the file is open.
+  Standard_EXPORT Standard_Boolean IsOpen() const;
+
+  //! Read up to theLength bytes starting at the given absolute offset.
+  //! Return the number of bytes read. Thread-safe.
+  Standard_EXPORT Standard_Size ReadAt (void*               theBuffer,
+                                        const Standard_Size theLength,
+                                        const uint64_t      theOffset) const;
+
+  //! Hint the system to read the given range of the file ahead.
+  Standard_EXPORT void Prefetch (const uint64_t theOffset, const uint64_t theLength) const;
+
+  //! Take a buffer of BufferSize bytes from the pool (or allocate a new one).
+  Standard_EXPORT uint8_t* AcquireBuffer() const;
+
+  //! Return a buffer taken by AcquireBuffer() to the pool.
+  Standard_EXPORT void ReleaseBuffer (uint8_t* theBuffer) const;
+
+private:
+  //! Copying is prohibited.
+  JtData_SharedFile (const JtData_SharedFile&);
+  JtData_SharedFile& operator = (const JtData_SharedFile&);
+
+private:
+#ifdef WNT
+  void*                              myFileHandle;
+#else
+  int                                myFileHandle;
+#endif
+
+  mutable NCollection_List<uint8_t*> myFreeBuffers;
+  mutable Standard_Mutex             myMutex;
+
+public:
+  DEFINE_STANDARD_ALLOC
+};
+
+#endif // _JtData_SharedFile_HeaderFile
@@ -18,8 +18,10 @@
 #define _JtData_VectorData_HeaderFile
 
 #include <Standard.hxx>
+#include <JtData_Arena.hxx>
 
 #include <cstring>
+#include <new>
 
 //! Vector data access.
 template <class ValT, class SizeT>
@@ -81,13 +83,16 @@ public:
   protected:
     Base() {}
 
-    Base (ValT* theData, SizeT theCount) : myData (theData), myCount (theCount) {}
+    Base (ValT* theData, SizeT theCount) : myData (theData), myCount (theCount), myIsInArena (Standard_False) {}
 
     Standard_Boolean allocate (const Size& theSize)
     {
       if (theSize.ValCount > 0)
       {
-        myData = reinterpret_cast <ValT*> (new ValHolder[theSize.ValCount]);
+        JtData_Arena* anArena = JtData_Arena::Current();
+        myIsInArena = anArena != 0L;
+        myData = myIsInArena ? arenaAllocate (*anArena, theSize.ValCount)
+                             : reinterpret_cast <ValT*> (new ValHolder[theSize.ValCount]);
         myCount = myData ? theSize.ElemCount : 0;
         return Standard_True;
       }
@@ -117,7 +122,18 @@ public:
 
     void free()
     {
-      if (myData)
+      if (!myData)
+        return;
+
+      if (myIsInArena)
+      {
+        // The memory is released with the arena, just destroy the values
+        const Standard_Size aValCount = *reinterpret_cast <const Standard_Size*> (
+          reinterpret_cast <const char*> (myData) - JtData_Arena::Alignment);
+        for (Standard_Size i = 0; i < aValCount; i++)
+          myData[i].~ValT();
+      }
+      else
         delete[] (reinterpret_cast <ValHolder*> (myData));
     }
 
@@ -125,6 +141,23 @@ public:
     {
       myCount = 0;
       myData = 0L;
+      myIsInArena = Standard_False;
+    }
+
+    //! Allocate and construct values in the arena. The number of values
+    //! is stored in front of them to destroy them on free().
+    static ValT* arenaAllocate (JtData_Arena& theArena, const Standard_Size theValCount)
+    {
+      char* aBlock = static_cast <char*> (
+        theArena.Allocate (JtData_Arena::Alignment + theValCount * sizeof (ValT)));
+      if (!aBlock)
+        return 0L;
+
+      *reinterpret_cast <Standard_Size*> (aBlock) = theValCount;
+      ValT* aData = reinterpret_cast <ValT*> (aBlock + JtData_Arena::Alignment);
+      for (Standard_Size i = 0; i < theValCount; i++)
+        ::new (aData + i) ValT;
+      return aData;
     }
 
   protected:
@@ -142,8 +175,9 @@ public:
     }
 
   protected:
-    ValT* myData;
-    SizeT myCount;
+    ValT*            myData;
+    SizeT            myCount;
+    Standard_Boolean myIsInArena; //!< is the data allocated from an arena
 
   public:
     DEFINE_STANDARD_ALLOC
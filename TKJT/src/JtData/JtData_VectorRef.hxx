@@ -39,6 +39,9 @@ public:
 
   JtData_VectorRef (const JtData_Vector<ValT, SizeT>& theVector) : data (theVector) {}
 
+  //! Copy references the same data, unlike assignment that copies the referenced values.
+  JtData_VectorRef (const JtData_VectorRef& theOther) : data (theOther.myData, theOther.myCount) {}
+
   template <class Struct>
   explicit JtData_VectorRef (Struct& theStruct)
     : data (reinterpret_cast <ValT*> (&theStruct), sizeof (Struct) / sizeof (ValT)) {}
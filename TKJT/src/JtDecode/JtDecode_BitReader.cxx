@@ -26,7 +26,8 @@ JtDecode_BitReader::Base::Base (JtData_Reader& theReader, Standard_Boolean theNe
 , myBitsBuf    (0)
 , myBitsLoaded (0)
 , myByteBuf    (0L)
-, myNextDWord  (0L) {}
+, myNextDWord  (0L)
+, myEndDWord   (0L) {}
 
 //=======================================================================
 //function : Base Destructor
@@ -65,7 +66,7 @@ Standard_Boolean JtDecode_BitReader::Raw::Load (const unsigned theBitsCount)
     Standard_Size aPreloadBitsCount  = aPreloadBytesCount * 8;
 
     // Check if there is enough space in the bit buffer to store the preloaded bits
-    if (myBitsLoaded + aPreloadBitsCount > 32)
+    if (myBitsLoaded + aPreloadBitsCount > 64)
       return Standard_False;
 
     // Read the needed number of bytes to the byte buffer
@@ -82,20 +83,13 @@ Standard_Boolean JtDecode_BitReader::Raw::Load (const unsigned theBitsCount)
     if (JtData_Model::IsLittleEndianHost)
       ByteSwap (aFirstBytes);
 
-    if (myBitsLoaded)
-    {
-      myBitsBuf    |= aFirstBytes >> myBitsLoaded;
-      myBitsLoaded += aPreloadBitsCount;
-    }
-    else
-    {
-      myBitsBuf    = aFirstBytes;
-      myBitsLoaded = aPreloadBitsCount;
-    }
+    myBitsBuf    |= (static_cast <uint64_t> (aFirstBytes) << 32) >> myBitsLoaded;
+    myBitsLoaded += aPreloadBitsCount;
 
     // Set next double word pointer to the first complete double word in the byte buffer
     myNextDWord = reinterpret_cast <const uint32_t*> (
                   reinterpret_cast <const uint8_t*> (myByteBuf) + aPreloadBytesCount);
+    myEndDWord  = myNextDWord + (aNewBytesCount - aPreloadBytesCount) / sizeof (uint32_t);
   }
 
   // Done
@@ -127,6 +121,7 @@ Standard_Boolean JtDecode_BitReader::U32::Load (const Standard_Size theValuesCou
   myBitsLoaded = 0;
   myByteBuf    = myReader->Load (theValuesCount * sizeof (Jt_U32));
   myNextDWord  = reinterpret_cast <const uint32_t*> (myByteBuf);
+  myEndDWord   = myByteBuf ? myNextDWord + theValuesCount : myNextDWord;
 
   // Done
   return myByteBuf != 0L;
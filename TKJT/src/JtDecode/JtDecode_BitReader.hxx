@@ -20,6 +20,10 @@
 #include <JtData_Reader.hxx>
 #include <JtData_ByteSwap.hxx>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 //! Bit Reader - implements buffered reading of subsequent bit fields from a JT file.
 //!
 //! Usage:
@@ -42,15 +46,11 @@ public:
     inline uint32_t ReadBit()
     {
       if (myBitsLoaded == 0)
-      {
-        loadBits();
-        myBitsLoaded = 31;
-      }
-      else
-        myBitsLoaded--;
+        refill();
 
-      uint32_t aResult = myBitsBuf >> 31;
+      uint32_t aResult = static_cast <uint32_t> (myBitsBuf >> 63);
       myBitsBuf <<= 1;
+      myBitsLoaded--;
       return aResult;
     }
 
@@ -58,14 +58,40 @@ public:
     //! @param theBitsCount - parameter may not be 0.
     inline uint32_t ReadU32 (const unsigned theBitsCount)
     {
-      return bitBuffer (theBitsCount) >> (32 - theBitsCount);
+      uint32_t aResult = PeekU32 (theBitsCount);
+      consume (theBitsCount);
+      return aResult;
     }
 
     //! Read the given number of bits (1...32) from the buffer as a signed integer.
     //! @param theBitsCount - parameter may not be 0.
     inline int32_t  ReadI32 (const unsigned theBitsCount)
     {
-      return static_cast <int32_t> (bitBuffer (theBitsCount)) >> (32 - theBitsCount);
+      int32_t aResult = static_cast <int32_t> (bitBuffer (theBitsCount) >> 32) >> (32 - theBitsCount);
+      consume (theBitsCount);
+      return aResult;
+    }
+
+    //! Return the given number of next bits (1...32) as an unsigned integer
+    //! without removing them from the buffer. Bits beyond the loaded data are zeros.
+    inline uint32_t PeekU32 (const unsigned theBitsCount)
+    {
+      return static_cast <uint32_t> (bitBuffer (theBitsCount) >> (64 - theBitsCount));
+    }
+
+    //! Return the number (0...32) of next bits equal to the given bit
+    //! without removing them from the buffer.
+    inline unsigned PeekRunLength (const uint32_t theBit)
+    {
+      uint32_t aBits = PeekU32 (32) ^ (0u - theBit);
+      return aBits ? leadingZeros (aBits) : 32;
+    }
+
+    //! Remove the given number of bits (0...32) from the buffer.
+    inline void SkipBits (const unsigned theBitsCount)
+    {
+      bitBuffer (theBitsCount);
+      consume (theBitsCount);
     }
 
     //! Read the given number of bits (0...32) from the buffer as an unsigned integer.
@@ -89,54 +115,65 @@ public:
     //! Protected constructor.
     Base (JtData_Reader& theReader, Standard_Boolean theNeedSwap);
 
-    //! Load next 32 bits from the byte buffer to the bit buffer.
-    inline void loadBits()
+    //! Append next 32 bits from the byte buffer to the bit buffer.
+    //! Appends zeros if the byte buffer is exhausted.
+    //! The bit buffer should have at most 32 bits loaded.
+    inline void refill()
     {
-      if (myNeedSwap)
-        ByteSwap (*myNextDWord++, myBitsBuf);
-      else
-        myBitsBuf = *myNextDWord++;
+      uint32_t aDWord = 0;
+      if (myNextDWord < myEndDWord)
+      {
+        if (myNeedSwap)
+          ByteSwap (*myNextDWord++, aDWord);
+        else
+          aDWord = *myNextDWord++;
+      }
+      myBitsBuf    |= static_cast <uint64_t> (aDWord) << (32 - myBitsLoaded);
+      myBitsLoaded += 32;
     }
 
-    //! Obtain a bit buffer containing the needed number of bits.
-    inline uint32_t bitBuffer (const unsigned theBitsCount)
+    //! Obtain a bit buffer containing at least the needed number (0...32) of bits.
+    inline uint64_t bitBuffer (const unsigned theBitsCount)
     {
-      uint32_t aResult;
-      if (myBitsLoaded >= theBitsCount)
-      {
-        aResult = myBitsBuf;
-        myBitsBuf   <<= theBitsCount;
-        myBitsLoaded -= theBitsCount;
-      }
-      else if (myBitsLoaded == 0)
-      {
-        loadBits();
-        aResult = myBitsBuf;
-        myBitsBuf  <<= theBitsCount;
-        myBitsLoaded = 32 - theBitsCount;
-      }
-      else
-      {
-        aResult = myBitsBuf;
-        Standard_Size aHeadSize = myBitsLoaded;
-        Standard_Size aTailSize = theBitsCount - aHeadSize;
-        loadBits();
-        aResult |= myBitsBuf >> aHeadSize;
-        myBitsBuf  <<= aTailSize;
-        myBitsLoaded = 32 - aTailSize;
-      }
-      return aResult;
+      if (myBitsLoaded < theBitsCount)
+        refill();
+      return myBitsBuf;
+    }
+
+    //! Remove the given number of loaded bits from the bit buffer.
+    inline void consume (const unsigned theBitsCount)
+    {
+      myBitsBuf   <<= theBitsCount;
+      myBitsLoaded -= theBitsCount;
+    }
+
+    //! Return number of leading zero bits of a non-zero value.
+    static inline unsigned leadingZeros (const uint32_t theValue)
+    {
+#if defined(__GNUC__)
+      return __builtin_clz (theValue);
+#elif defined(_MSC_VER)
+      unsigned long anIndex;
+      _BitScanReverse (&anIndex, theValue);
+      return 31 - anIndex;
+#else
+      unsigned aCount = 0;
+      for (uint32_t aMask = 0x80000000; (theValue & aMask) == 0; aMask >>= 1)
+        aCount++;
+      return aCount;
+#endif
     }
 
   protected:
     JtData_Reader*   myReader;     //!< external reader
     Standard_Boolean myNeedSwap;   //!< is byte swapping needed after reading from the external reader
 
-    uint32_t         myBitsBuf;    //!< bit buffer (32 bits) - acts as a queue: bits are left-shifted out when read
+    uint64_t         myBitsBuf;    //!< bit buffer (64 bits) - acts as a queue: bits are left-shifted out when read
     Standard_Size    myBitsLoaded; //!< number of bits rest in the bit buffer
 
     const void*      myByteBuf;    //!< byte buffer (allocated by the external reader)
     const uint32_t*  myNextDWord;  //!< address of the next double word to be read from the byte buffer
+    const uint32_t*  myEndDWord;   //!< address after the last complete double word in the byte buffer
   };
 
   //! Implementation of raw bytes loading behavior.
@@ -59,6 +59,7 @@ protected:
     JtDecode_Int32CDP * myPackage;
     JtDecode_Unpack   * myUnpacker;
     DecodedData       * myResult;
+    JtData_Arena      * myArena;
   };
 
 public:
@@ -98,17 +99,24 @@ public:
   }
 
   //! A decoding functor. Can be called only once for an instance.
+  //! Temporary buffers are allocated from the arena that was current
+  //! for the thread creating the functor, if any.
   class DecodingFunctor : protected DecodingFunctorData
   {
   public:
-    void operator ()() const { *myResult = myPackage->decode (*myUnpacker); }
+    void operator ()() const
+    {
+      JtData_Arena::Scope anArenaScope (myArena);
+      *myResult = myPackage->decode (*myUnpacker);
+    }
   };
 
   //! Create I32 decoding functor.
   DecodingFunctor GetDecodingFunctor (Jt_VecI32& theResult,
                                       JtDecode_Unpack& theUnpacker = JtDecode_Unpack_Null)
   {
-    DecodingFunctorData aData = {this, &theUnpacker, reinterpret_cast<DecodedData*> (&theResult)};
+    DecodingFunctorData aData = {this, &theUnpacker, reinterpret_cast<DecodedData*> (&theResult),
+                                 JtData_Arena::Current()};
     return reinterpret_cast <DecodingFunctor&> (aData);
   }
 
@@ -116,7 +124,8 @@ public:
   DecodingFunctor GetDecodingFunctor (Jt_VecU32& theResult,
                                       JtDecode_Unpack& theUnpacker = JtDecode_Unpack_Null)
   {
-    DecodingFunctorData aData = {this, &theUnpacker, reinterpret_cast<DecodedData*> (&theResult)};
+    DecodingFunctorData aData = {this, &theUnpacker, reinterpret_cast<DecodedData*> (&theResult),
+                                 JtData_Arena::Current()};
     return reinterpret_cast <DecodingFunctor&> (aData);
   }
 
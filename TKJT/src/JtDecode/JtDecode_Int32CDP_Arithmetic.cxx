@@ -16,12 +16,96 @@
 
 #include <JtDecode_Int32CDP_Arithmetic.hxx>
 
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  //! Contexts with total count up to this limit get a direct lookup table.
+  static const unsigned DIRECT_LOOKUP_LIMIT = 1024;
+
+  //! Index mapping a cumulative count to the probability context entry
+  //! it falls into. Keeps cumulative frequencies of the entries for
+  //! a binary search and, for small contexts, a direct lookup table.
+  //! Data of all contexts is stored in one array.
+  class SymbolIndex
+  {
+  public:
+    //! Build the index of the given probability contexts.
+    SymbolIndex (const JtData_Vector<JtDecode_ProbContextI32>& theProbContexts)
+      : myContexts (theProbContexts.Count())
+    {
+      for (Standard_Size aCtxIdx = 0; aCtxIdx < theProbContexts.Count(); aCtxIdx++)
+      {
+        const JtDecode_ProbContextI32& aContext = theProbContexts[aCtxIdx];
+        Context& anIndex = myContexts[aCtxIdx];
+        anIndex.Start  = myData.size();
+        anIndex.NbLast = aContext.Size() ? aContext.Size() - 1 : 0;
+
+        // cumulative counts below each entry and the total count
+        uint32_t aSymHigh = 0;
+        myData.push_back (aSymHigh);
+        for (Standard_Size anEntryIdx = 0; anEntryIdx < aContext.Size(); anEntryIdx++)
+        {
+          aSymHigh += aContext[anEntryIdx].occCount;
+          myData.push_back (aSymHigh);
+        }
+
+        // entry index for each count value
+        anIndex.Total  = aSymHigh;
+        anIndex.Direct = aSymHigh <= DIRECT_LOOKUP_LIMIT ? myData.size() : 0;
+        if (anIndex.Direct)
+        {
+          for (Standard_Size anEntryIdx = 0; anEntryIdx < aContext.Size(); anEntryIdx++)
+            myData.resize (myData[anIndex.Start + anEntryIdx + 1] + anIndex.Direct,
+                           static_cast<uint32_t> (anEntryIdx));
+        }
+      }
+    }
+
+    //! Return index of the entry of the given context containing the given count.
+    Standard_Size Find (const Standard_Size theContext, const unsigned theCount) const
+    {
+      const Context& anIndex = myContexts[theContext];
+      if (anIndex.Direct && theCount < anIndex.Total)
+        return myData[anIndex.Direct + theCount];
+
+      // the first entry with the cumulative count above the searched one
+      const uint32_t* aFirst = &myData[anIndex.Start] + 1;
+      return std::upper_bound (aFirst, aFirst + anIndex.NbLast, theCount) - aFirst;
+    }
+
+    //! Return total count of the symbols before the given entry of the given context.
+    unsigned CumulativeLow (const Standard_Size theContext, const Standard_Size theEntry) const
+    {
+      return myData[myContexts[theContext].Start + theEntry];
+    }
+
+  private:
+    struct Context
+    {
+      Standard_Size Start;  //!< Offset of the cumulative counts in the common array
+      Standard_Size NbLast; //!< Index of the last context entry
+      Standard_Size Total;  //!< Total count of the context symbols
+      Standard_Size Direct; //!< Offset of the direct lookup table or 0 if there is none
+    };
+
+    std::vector<Context>  myContexts;
+    std::vector<uint32_t> myData;
+  };
+}
+
+//=======================================================================
+//function : decode
+//purpose  : Decode the loaded bits
+//=======================================================================
 void JtDecode_Int32CDP_Arithmetic::decode (int32_t* theResultPtr,
                                            int32_t* theResultEnd,
                                      const int32_t* theOOBDataPtr)
 {
   // Initialize
   Standard_Size aCurContextIdx = 0;
+  const SymbolIndex aSymbolIndex (myProbContexts);
 
   uint16_t aLow  = 0x0000;
   uint16_t aHigh = 0xFFFF;
@@ -39,14 +123,10 @@ void JtDecode_Int32CDP_Arithmetic::decode (int32_t* theResultPtr,
     unsigned aRange = aHigh - aLow + 1;
     unsigned aCount = (((aCode - aLow + 1) * aSymbolsInCurCtx - 1) / aRange);
 
-    const JtDecode_ProbContextI32::Entry* aCurEntryPtr = &aCurContext[0];
-    unsigned aSymHigh = aCurEntryPtr->occCount;
-    while (aSymHigh <= aCount)
-    {
-      aCurEntryPtr++;
-      aSymHigh += aCurEntryPtr->occCount;
-    }
-    unsigned aSymLow = aSymHigh - aCurEntryPtr->occCount;
+    const Standard_Size anEntryIdx = aSymbolIndex.Find (aCurContextIdx, aCount);
+    const JtDecode_ProbContextI32::Entry* aCurEntryPtr = &aCurContext[anEntryIdx];
+    unsigned aSymLow  = aSymbolIndex.CumulativeLow (aCurContextIdx, anEntryIdx);
+    unsigned aSymHigh = aSymLow + aCurEntryPtr->occCount;
 
     // write output value
     if (aCurEntryPtr->symbol != -2)
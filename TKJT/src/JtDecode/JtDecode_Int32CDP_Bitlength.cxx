@@ -29,8 +29,19 @@ void JtDecode_Int32CDP_Bitlength::decode (int32_t* theResultPtr, int32_t* theRes
     {
       uint32_t aFirstBit = ReadBit();
       signed aStep = aFirstBit ? STEP_SIZE : -STEP_SIZE;
-      do aFieldWidth += aStep;
-      while (ReadBit() == aFirstBit);
+      aFieldWidth += aStep;
+
+      // change the width by one step for each repetition of the first bit
+      // and skip the terminating opposite bit
+      unsigned aRunLength;
+      do
+      {
+        aRunLength = PeekRunLength (aFirstBit);
+        aFieldWidth += aStep * aRunLength;
+        SkipBits (aRunLength);
+      }
+      while (aRunLength == 32);
+      SkipBits (1);
     }
 
     // read value
@@ -16,336 +16,252 @@
 
 #include <JtDecode_Int32CDP_Huffman.hxx>
 
-#include <algorithm>
 #include <vector>
-#include <list>
-#include <map>
 
-/* 
- * The data binded to tree nodes 
- */
-
-
-
-class HuffCodeData
-{
-  public:
-  HuffCodeData (Standard_Integer theSymbol, Standard_Integer theAssValue)
-    : mySymbol (theSymbol), myValue (theAssValue), myCodeLength (0), myBitCode (0), myIndex (0) {}
-
-  HuffCodeData (Standard_Integer theSymbol, Standard_Integer theAssValue,
-                Standard_Integer theCodeLen, Standard_Integer theBitCode)
-    : mySymbol (theSymbol), myValue (theAssValue),
-      myCodeLength (theCodeLen), myBitCode (theBitCode), myIndex (0) {}
-
-  Standard_Integer Symbol()   const {return mySymbol;}
-  Standard_Integer CodeLen()  const {return myCodeLength;}
-  Standard_Integer BitCode()  const {return myBitCode;}
-  Standard_Integer Value()    const {return myValue;}
-  Standard_Integer Index()    const {return myIndex;}
-
-  void SetSymbol   (Standard_Integer theSymbol)   {mySymbol = theSymbol;}
-  void SetCodeLen  (Standard_Integer theCodeLen)  {myCodeLength = theCodeLen;}
-  void SetBitCode  (Standard_Integer theBitCode)  {myBitCode = theBitCode;}
-  void SetValue    (Standard_Integer theAssValue) {myValue = theAssValue;}
-  void SetIndex    (Standard_Integer theIndex)    {myIndex = theIndex;}
-
-private:
-  Standard_Integer mySymbol;
-  Standard_Integer myValue;
-  Standard_Integer myCodeLength;
-  Standard_Integer myBitCode;
-  Standard_Integer myIndex;
-};
-
-bool compareCodes (const HuffCodeData* theData1, const HuffCodeData* theData2)
-{
-  int ret = theData2->CodeLen() - theData1->CodeLen();
-  if (ret == 0)
-    ret = theData2->BitCode() - theData1->BitCode();
-
-  return ret < 0;
-}
-
-/*
- * Class intended to bind codes to the nodes of Huffman tree 
- */
-
-class HuffCodecContext
+namespace
 {
-public:
-  HuffCodecContext() : myCode (0), myCodeLength (0) {}
-
-  Standard_Integer Code()    {return myCode;}
-  Standard_Integer CodeLen() {return myCodeLength;}
-
-  void LeftShift()       {myCode = (myCode << 1) & 0xFFFF;}
-  void RightShift()      {myCode = myCode >> 1;}
-  void BitOr (int value) {myCode = (myCode | value) & 0xFFFF;}
-  void IncLength()       {myCodeLength++;}
-  void DecLength()       {myCodeLength--;}
-
-  void Add (HuffCodeData* data)
+  //! Number of bits resolved by one lookup table.
+  static const unsigned TABLE_BITS = 8;
+
+  //! Huffman tree built in a flat array of nodes.
+  //! The tree shape (and so the codes) is the same as one built by
+  //! the reference implementation: nodes are combined in order given
+  //! by a binary min-heap of symbol counts; bit 1 selects the left
+  //! (first extracted) child, bit 0 - the right one.
+  class HuffTree
   {
-    myCodes.push_front (data);
-  }
-
-private:
-
-  Standard_Integer myCode;       // Current code which is constructed
-  Standard_Integer myCodeLength; // Length of Huffman code currently constructed
-
-  std::list<HuffCodeData*> myCodes;
-};
-
-/* 
- * Huffman's tree node
- */
-class HuffTreeNode
-{
-public:
-
-  HuffTreeNode()
-    : left (NULL), right (NULL), data (NULL), symCount (0) {}
-
-  HuffTreeNode (int theSymCount, HuffCodeData* theData)
-    : left (NULL), right (NULL), data (theData), symCount (theSymCount) {}
-
-  HuffTreeNode (HuffTreeNode* theLeft, HuffTreeNode* theRight, int theSymCount, HuffCodeData* theData)
-    : left (theLeft), right (theRight), data (theData), symCount (theSymCount) {}
-
-  HuffTreeNode*        Left()                {return left;}
-  HuffTreeNode*        Right()               {return right;}
-  HuffCodeData*        Data()                {return data;}
-  Standard_Integer     SymCount()            {return symCount;}
-  Standard_Integer     Symbol()              {return data->Symbol();}
-  Standard_Integer     AssociatedValue()     {return data->Value();}
-
-  void SetCode    (Standard_Integer code)    {data->SetBitCode (code);}
-  void SetCodeLen (Standard_Integer codeLen) {data->SetCodeLen (codeLen);}
+  public:
+    struct Node
+    {
+      int     SymCount; //!< Total count of symbols under the node
+      int32_t Left;     //!< Index of the left child node or -1 for a leaf
+      int32_t Right;    //!< Index of the right child node or -1 for a leaf
+      int32_t Entry;    //!< Index of the context entry for a leaf
+    };
+
+    //! Build the tree of the given probability context.
+    HuffTree (const JtDecode_ProbContextI32& theProbContext)
+    {
+      const int32_t aNbEntries = static_cast<int32_t> (theProbContext.Size());
+      myNodes.reserve (aNbEntries * 2);
+      myHeap .reserve (aNbEntries);
 
-  Standard_Boolean LowerThan (HuffTreeNode* o) {return symCount < o->symCount;}
-  Standard_Boolean IsLeaf()                    {return (left == NULL) && (right == NULL);}
+      // Initialize all the leaf nodes and add them to the heap
+      for (int32_t i = 0; i < aNbEntries; i++)
+      {
+        Node aLeaf = {static_cast<int> (theProbContext[i].occCount), -1, -1, i};
+        myNodes.push_back (aLeaf);
+        heapAdd (i);
+      }
 
-  Standard_Integer DesscendantMaxDepth()
-  {
-    int l = 0;
-    int r = 0;
+      // Combine two lowest-frequency nodes until one remains
+      while (myHeap.size() > 1)
+      {
+        const int32_t aNode1 = heapTop();
+        const int32_t aNode2 = heapTop();
 
-    if (left != NULL)
-      l += left->DesscendantMaxDepth();
+        Node aParent = {myNodes[aNode1].SymCount + myNodes[aNode2].SymCount, aNode1, aNode2, -1};
+        myNodes.push_back (aParent);
+        heapAdd (static_cast<int32_t> (myNodes.size()) - 1);
+      }
 
-    if (right != NULL)
-      r += right->DesscendantMaxDepth();
+      myRoot = myHeap.empty() ? -1 : myHeap.front();
+    }
 
-    return std::max (l, r) + 1;
-  }
+    //! Return index of the root node or -1 for an empty tree.
+    int32_t Root() const { return myRoot; }
 
-private:
-  HuffTreeNode* left;
-  HuffTreeNode* right;
-  HuffCodeData* data;
-  int symCount;
-};
+    //! Return node by index.
+    const Node& operator[] (const int32_t theIndex) const { return myNodes[theIndex]; }
 
-class HuffHeap
-{
-public:
+  private:
+    //! Add a node to the heap.
+    void heapAdd (const int32_t theNode)
+    {
+      myHeap.push_back (theNode);
 
-  HuffHeap() {}
+      const int aCount = myNodes[theNode].SymCount;
+      Standard_Size i = myHeap.size();
+      while (i != 1 && myNodes[myHeap[i / 2 - 1]].SymCount > aCount)
+      {
+        myHeap[i - 1] = myHeap[i / 2 - 1];
+        i = i / 2;
+      }
+      myHeap[i - 1] = theNode;
+    }
 
-  //! Returns the size of the heap.
-  Standard_Size Size()
-  {
-    return _heap.size();
-  }
+    //! Extract the node with the smallest count from the heap.
+    int32_t heapTop()
+    {
+      const int32_t aTop = myHeap.front();
 
-  //! Add a new tree node in a sorted way.
-  void Add (HuffTreeNode* theHuffTreeNode)
-  {
-    _heap.push_back (theHuffTreeNode);
+      Standard_Size aSize = myHeap.size() - 1;
+      const int32_t aLast = myHeap[aSize];
+      Standard_Size i = 1, ci = 2;
+      while (ci <= aSize)
+      {
+        if (ci < aSize && myNodes[myHeap[ci - 1]].SymCount > myNodes[myHeap[ci]].SymCount)
+          ci++;
 
-    Standard_Size i = _heap.size();
+        if (myNodes[aLast].SymCount < myNodes[myHeap[ci - 1]].SymCount)
+          break;
 
-    while ((i != 1) && (_heap[(i / 2) - 1]->SymCount() > theHuffTreeNode->SymCount()))
-    {
-      // overwrite i with the parent of i
-      _heap[i - 1] = _heap[(i / 2) - 1];
+        myHeap[i - 1] = myHeap[ci - 1];
+        i = ci;
+        ci *= 2;
+      }
+      myHeap[i - 1] = aLast;
+      myHeap.pop_back();
 
-      // Parent of i is a new i
-      i = i / 2;
+      return aTop;
     }
 
-    // Overwrite current position (i) with the new element
-    _heap[i - 1] = theHuffTreeNode;
-  }
+  private:
+    std::vector<Node>    myNodes;
+    std::vector<int32_t> myHeap;
+    int32_t              myRoot;
+  };
 
-  //! Remove the root node.
-  void Remove()
+  //! Multi-level lookup tables decoding TABLE_BITS bits per step.
+  //! All tables are stored in one array: the primary table first,
+  //! followed by secondary tables for codes longer than TABLE_BITS.
+  class HuffTables
   {
-    if (_heap.size() == 0)
+  public:
+    enum Kind
     {
-      return;
-    }
+      Kind_Value,   //!< leaf with an associated value
+      Kind_OOB,     //!< leaf of the out-of-band symbol
+      Kind_SubTable //!< code continues in a secondary table
+    };
 
-    Standard_Size size = _heap.size();
-    HuffTreeNode* y = _heap[size - 1];
-    Standard_Size i = 1;                // i is current "parent", which shall be removed / overwritten
-    Standard_Size ci = 2;                // ci is current "child"
-    size -= 1;                // The new size is decremented by one
+    struct Entry
+    {
+      int32_t Value;  //!< Associated value or index of the secondary table
+      uint8_t Length; //!< Number of code bits resolved by this entry
+      uint8_t Type;   //!< Entry kind
+    };
 
-    while (ci <= size)
+  public:
+    //! Build the tables for the given probability context.
+    HuffTables (const JtDecode_ProbContextI32& theProbContext)
     {
-      // Go to the left or to the right? Use the "smaller" element
-      if ((ci < size) && (_heap[ci - 1]->SymCount() > _heap[ci]->SymCount()))
+      HuffTree aTree (theProbContext);
+      if (aTree.Root() < 0)
+        return;
+
+      // a tree of a single symbol is decoded with 1-bit codes
+      if (aTree[aTree.Root()].Left < 0)
       {
-        ci += 1;
+        myEntries.assign (static_cast<Standard_Size> (1) << TABLE_BITS,
+                          leafEntry (theProbContext, aTree[aTree.Root()], 1));
+        return;
       }
 
-      // If the new "last" element already fits (it has to be smaller than the smallest
-      // childs of i), than break the loop
-      if (y->SymCount() < _heap[ci - 1]->SymCount())
-        break;
-
-      // Otherwise move the "child" up to the "parent" and continue with i at ci
-      _heap[i - 1] = _heap[ci - 1];
-      i = ci;
-      ci *= 2;
+      // build tables breadth first, each internal node at a table boundary gets its own table
+      std::vector<int32_t> aTableRoots (1, aTree.Root());
+      for (Standard_Size aTableIdx = 0; aTableIdx < aTableRoots.size(); aTableIdx++)
+      {
+        const Standard_Size aTableStart = myEntries.size();
+        myEntries.resize (aTableStart + (static_cast<Standard_Size> (1) << TABLE_BITS));
+        fill (theProbContext, aTree, aTableRoots[aTableIdx], 0, 0, aTableStart, aTableRoots);
+      }
     }
 
-    // Set "last" element to the current position i
-    _heap[i - 1] = y;
+    //! Return true if there are no tables.
+    Standard_Boolean IsEmpty() const { return myEntries.empty(); }
 
-    // Resize node list by -1
-    _heap.pop_back();
-  }
+    //! Return the primary table.
+    const Entry* Data() const { return &myEntries.front(); }
 
-  //! Returns the "smallest" node (root node) and decrease the heap.
-  HuffTreeNode* Top()
-  {
-    if(_heap.size() == 0)
+  private:
+    //! Create a leaf entry.
+    static Entry leafEntry (const JtDecode_ProbContextI32& theProbContext,
+                            const HuffTree::Node&          theLeaf,
+                            const unsigned                 theLength)
     {
-      return NULL;
+      const JtDecode_ProbContextI32::Entry& aSymbol = theProbContext[theLeaf.Entry];
+      Entry anEntry = {aSymbol.associatedValue, static_cast<uint8_t> (theLength),
+                       static_cast<uint8_t> (aSymbol.symbol == -2 ? Kind_OOB : Kind_Value)};
+      return anEntry;
     }
 
-    HuffTreeNode* huffTreeNode = _heap.front();
-    Remove();
-    return huffTreeNode;
-  }
-
-private:
-
-  //! Internal list of nodes.
-  std::vector<HuffTreeNode*> _heap;
-};
-
-/*
- * Create tree from the probability table
- */
-static HuffTreeNode* BuildHuffmanTree (const JtDecode_ProbContextI32& theProbContext)
-{
-  HuffHeap aHuffHeap;
-
-  // Initialize all the nodes and add them to the heap.
-  unsigned i = 0;
-
-  while (i < theProbContext.Size())
-  {
-    const JtDecode_ProbContextI32::Entry& anEntry = theProbContext[i];
-
-    HuffCodeData* data = new HuffCodeData (anEntry.symbol, anEntry.associatedValue);
-    data->SetIndex (i++);
-
-    HuffTreeNode* node = new HuffTreeNode (anEntry.occCount, data);
-    aHuffHeap.Add (node);
-  }
-
-  // Build a tree of the nodes
-  while (aHuffHeap.Size() > 1)
-  {
-    // Get the two lowest-frequency nodes
-    HuffTreeNode* node1 = aHuffHeap.Top();
-    HuffTreeNode* node2 = aHuffHeap.Top();
-
-    HuffCodeData* data = new HuffCodeData (0xdeadbeef, 0);
-    data->SetIndex (i++);
-
-    // Combine the low-freq nodes into one node
-    HuffTreeNode* newNode = new HuffTreeNode (node1, node2,
-            node1->SymCount() + node2->SymCount(), data);
-
-    // Add the new node to the heap
-    aHuffHeap.Add (newNode);
-  }
-
-  return aHuffHeap.Top();
-}
-
-/*
- *Performs traversing of the tree in order to bind a code to each leaf. 
- *
- */
-static void AssignCodeToTree (HuffTreeNode* theNode, HuffCodecContext* theContext)
-{
-  if (theNode->Left() != NULL)
-  {
-    theContext->LeftShift();
-    theContext->BitOr (1);
-    theContext->IncLength();
-
-    AssignCodeToTree (theNode->Left(), theContext);
-
-    theContext->DecLength();
-    theContext->RightShift();
-  }
-
-  if (theNode->Right() != NULL)
-  {
-    theContext->LeftShift();
-    theContext->IncLength();
-
-    AssignCodeToTree (theNode->Right(), theContext);
-
-    theContext->DecLength();
-    theContext->RightShift();
-  }
-
-  if (theNode->Right() != NULL)
-    return;
+    //! Fill entries of a table for all codes passing through the given node
+    //! at the given depth (relative to the table root) with the given code prefix.
+    void fill (const JtDecode_ProbContextI32& theProbContext,
+               const HuffTree&                theTree,
+               const int32_t                  theNode,
+               const unsigned                 theDepth,
+               const uint32_t                 thePrefix,
+               const Standard_Size            theTableStart,
+               std::vector<int32_t>&          theTableRoots)
+    {
+      const HuffTree::Node& aNode = theTree[theNode];
+      if (aNode.Left < 0 || theDepth == TABLE_BITS)
+      {
+        Entry anEntry;
+        if (aNode.Left < 0)
+          anEntry = leafEntry (theProbContext, aNode, theDepth);
+        else
+        {
+          // secondary tables follow in order of their roots
+          anEntry.Value  = static_cast<int32_t> (theTableRoots.size() << TABLE_BITS);
+          anEntry.Length = TABLE_BITS;
+          anEntry.Type   = Kind_SubTable;
+          theTableRoots.push_back (theNode);
+        }
+
+        const unsigned aFreeBits = TABLE_BITS - theDepth;
+        const Standard_Size aFirst = theTableStart + (static_cast<Standard_Size> (thePrefix) << aFreeBits);
+        const Standard_Size aLast  = aFirst + (static_cast<Standard_Size> (1) << aFreeBits);
+        for (Standard_Size i = aFirst; i < aLast; i++)
+          myEntries[i] = anEntry;
+        return;
+      }
 
-  // Set the code and its length for the node
-  theNode->SetCode (theContext->Code());
-  theNode->SetCodeLen (theContext->CodeLen());
+      fill (theProbContext, theTree, aNode.Left,  theDepth + 1, (thePrefix << 1) | 1, theTableStart, theTableRoots);
+      fill (theProbContext, theTree, aNode.Right, theDepth + 1, (thePrefix << 1),     theTableStart, theTableRoots);
+    }
 
-  theContext->Add (theNode->Data());
+  private:
+    std::vector<Entry> myEntries;
+  };
 }
 
+//=======================================================================
+//function : decode
+//purpose  : Decode the loaded bits using lookup tables
+//=======================================================================
 void JtDecode_Int32CDP_Huffman::decode (int32_t* theResultPtr,
                                         int32_t* theResultEnd,
                                   const int32_t* theOOBDataPtr)
 {
-  // Build Huffman tree based on the context
-  HuffTreeNode* aHuffTree = BuildHuffmanTree (myProbContexts[0]);
+  // Build lookup tables for the codes of the first probability context
+  const HuffTables aTables (myProbContexts[0]);
+  if (aTables.IsEmpty())
+  {
+    while (theResultPtr < theResultEnd)
+      *theResultPtr++ = 0;
+    return;
+  }
 
-  // Make canonical
-  HuffCodecContext aCodecContext;
-  AssignCodeToTree (aHuffTree, &aCodecContext);
+  const HuffTables::Entry* aPrimaryTable = aTables.Data();
 
   // Decoding
   while (theResultPtr < theResultEnd)
   {
-    // walk down the tree to a leaf node
-    HuffTreeNode* aNode = aHuffTree;
-    do
+    // look up the next bits, descending to secondary tables for long codes
+    const HuffTables::Entry* anEntry = aPrimaryTable + PeekU32 (TABLE_BITS);
+    while (anEntry->Type == HuffTables::Kind_SubTable)
     {
-      uint32_t aCurBit = ReadBit();
-      aNode = aCurBit ? aNode->Left() : aNode->Right();
+      SkipBits (TABLE_BITS);
+      anEntry = aPrimaryTable + anEntry->Value + PeekU32 (TABLE_BITS);
     }
-    while (!aNode->IsLeaf());
+    SkipBits (anEntry->Length);
 
     // construct the final value taking into account OOB data
-    if (aNode->Symbol() != -2)
-      *theResultPtr++ = aNode->AssociatedValue();
+    if (anEntry->Type == HuffTables::Kind_Value)
+      *theResultPtr++ = anEntry->Value;
     else
       *theResultPtr++ = *theOOBDataPtr++;
   }
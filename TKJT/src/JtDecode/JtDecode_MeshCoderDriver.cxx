@@ -73,25 +73,48 @@ private:
   std::vector<uint32_t> myVector;
 };
 
+// Element access of the DualVFMesh arrays: range-checked in debug builds,
+// unchecked in release builds where it sits on the hot decoding path.
+#ifdef OCCT_DEBUG
+  #define JT_VFM_ELEM(theArray, theIndex) (theArray).at (theIndex)
+#else
+  #define JT_VFM_ELEM(theArray, theIndex) (theArray)[theIndex]
+#endif
+
 //! The DualVFMesh (Dual Vertex-Facet Mesh) is a support class paired with
 //! the topology decoder itself, and represents a closed two-manifold polygon
 //! mesh. The topology decoder reconstructs the encoded dual mesh into a DualVFMesh,
 //! building it one vertex and one facet at a time. When the decoder is finished,
 //! it will have visited each vertex and each face of the dual mesh exactly once.
+//!
+//! The mesh is stored as a struct of arrays: per-vertex and per-face properties
+//! live in separate arrays, and the adjacency lists are kept in compressed sparse
+//! row form (an offsets array with one extra trailing entry per element kind).
+//! Attribute masks are stored inline, so creating a face never allocates memory
+//! on its own once the storage has been reserved.
 class JtDecode_DualVFMesh
 {
 public:
-  
-  JtDecode_DualVFMesh()  {}
 
-  JtDecode_DualVFMesh (const JtDecode_DualVFMesh &rhs);
-
-  JtDecode_DualVFMesh &operator= (const JtDecode_DualVFMesh &rhs);
+  JtDecode_DualVFMesh()
+  {
+    clear();
+  }
 
   // ========== Topology Interface ==========
 
   bool clear();
 
+  //! Preallocate storage for the given numbers of vertices, faces,
+  //! vertex-face and face-vertex connections, face attributes
+  //! and words of the attribute masks of large faces.
+  void reserve (int32_t nVts,
+                int32_t nVtxFaces,
+                int32_t nFaces,
+                int32_t nFaceVts,
+                int32_t nAttrs,
+                int32_t nMaskWords);
+
   // Vertex creation
 
   bool isValidVtx (int32_t iVtx) const;
@@ -112,7 +135,10 @@ public:
 
   bool newFace (int32_t iFace, int32_t cDegree, int32_t cFaceAttrs = 0, uint64_t uFaceAttrMask = 0, uint16_t uFlags = 0);
 
-  bool newFace (int32_t iFace, int32_t cDegree, int32_t cFaceAttrs, const JtDecode_BitVec* pvbFaceAttrMask, uint16_t uFlags);
+  //! Create a face of degree exceeding cMBits; its attribute mask is given
+  //! as an array of nMaskWords words, missing words are treated as zeros.
+  bool newFace (int32_t iFace, int32_t cDegree, int32_t cFaceAttrs,
+                const uint32_t* puFaceAttrMask, int32_t nMaskWords, uint16_t uFlags);
 
   bool setFaceFlags (int32_t iFace, uint16_t uFlags);
 
@@ -131,32 +157,32 @@ public:
   // Queries
   int32_t valence (int32_t iVtx) const
   {
-    return _vVtxEnts[iVtx].cVal;
+    return JT_VFM_ELEM (_viVtxFVI, iVtx + 1) - JT_VFM_ELEM (_viVtxFVI, iVtx);
   }
 
   int32_t degree (int32_t iFace) const
   {
-    return _vFaceEnts[iFace].cDeg;
+    return JT_VFM_ELEM (_viFaceFVI, iFace + 1) - JT_VFM_ELEM (_viFaceFVI, iFace);
   }
 
   int32_t face (int32_t iVtx, int32_t iFaceSlot) const
   {
-    return _viVtxFaceIndices[(_vVtxEnts[iVtx]).iVFI + iFaceSlot];
+    return JT_VFM_ELEM (_viVtxFaceIndices, JT_VFM_ELEM (_viVtxFVI, iVtx) + iFaceSlot);
   }
 
   int32_t vtx (int32_t iFace, int32_t iVtxSlot) const
   {
-    return _viFaceVtxIndices[_vFaceEnts[iFace].iFVI + iVtxSlot];
+    return JT_VFM_ELEM (_viFaceVtxIndices, JT_VFM_ELEM (_viFaceFVI, iFace) + iVtxSlot);
   }
 
   int32_t numVts() const
   {
-    return static_cast<int32_t>(_vVtxEnts.size());
+    return static_cast<int32_t>(_vuVtxFlags.size());
   }
 
   int32_t numFaces() const
   {
-    return static_cast<int32_t>(_vFaceEnts.size());
+    return static_cast<int32_t>(_vuFaceFlags.size());
   }
 
   int32_t numAttrs() const
@@ -166,17 +192,19 @@ public:
 
   int32_t numAttrs (int32_t iFace) const
   {
-    return _vFaceEnts[iFace].cFaceAttrs;
+    return JT_VFM_ELEM (_viFaceFAI, iFace + 1) - JT_VFM_ELEM (_viFaceFAI, iFace);
   }
 
-  uint64_t attrMask (int32_t iFace) const
+  //! Test the attribute mask bit of the given vertex slot of the face.
+  bool attrMaskBit (int32_t iFace, int32_t iVtxSlot) const
   {
-    return _vFaceEnts[iFace].uAttrMask;
-  }
+    const uint64_t uAttrMask = JT_VFM_ELEM (_vuFaceAttrMask, iFace);
+    if (degree (iFace) <= cMBits)
+      return (uAttrMask & ((uint64_t)1 << iVtxSlot)) != 0;
 
-  const JtDecode_BitVec* attrMaskV (int32_t iFace) const
-  {
-    return _vFaceEnts[iFace].pvbAttrMask;
+    // For large faces the mask field holds an offset into the mask words storage
+    const uint32_t uWord = JT_VFM_ELEM (_vuFaceAttrMaskWords, static_cast<size_t> (uAttrMask) + (iVtxSlot >> 5));
+    return (uWord & (1u << (iVtxSlot & 0x1F))) != 0;
   }
 
   int32_t findVtxSlot (int32_t iFace, int32_t iTargVtx) const;
@@ -185,41 +213,34 @@ public:
 
   int32_t emptyFaceSlots (int32_t iFace) const
   {
-    return _vFaceEnts[iFace].cEmptyDeg;
+    return JT_VFM_ELEM (_vcFaceEmptyDeg, iFace);
   }
 
-  int32_t vtxFaceAttr (int32_t iVtx, int32_t iFace)
+  int32_t vtxFaceAttr (int32_t iVtx, int32_t iFace) const
   {
-    FaceEnt& rVE = _vFaceEnts.at (iFace);
-    if (rVE.cFaceAttrs <= 0)
+    const int32_t cFaceAttrs = numAttrs (iFace);
+    if (cFaceAttrs <= 0)
     {
       return -1;
     }
 
-    int32_t cDeg = rVE.cDeg;
-    int32_t iAttrSlot = rVE.cFaceAttrs - 1;
+    const int32_t cDeg = degree (iFace);
+    const int32_t iFVI = JT_VFM_ELEM (_viFaceFVI, iFace);
+    const int32_t iFAI = JT_VFM_ELEM (_viFaceFAI, iFace);
+    int32_t iAttrSlot = cFaceAttrs - 1;
     for (int32_t iVtxSlot = 0; iVtxSlot < cDeg; iVtxSlot++)
     {
-      int32_t iSlot = iVtxSlot;
-      if (cDeg <= JtDecode_DualVFMesh::cMBits)
-      {
-        if ((rVE.uAttrMask & ((uint64_t)1 << iSlot)) != 0)
-          iAttrSlot++;
-      }
-      else
-      {
-        if (rVE.pvbAttrMask->Test (iSlot))
-          iAttrSlot++;
-      }
+      if (attrMaskBit (iFace, iVtxSlot))
+        iAttrSlot++;
 
-      if (iAttrSlot >= rVE.cFaceAttrs)
+      if (iAttrSlot >= cFaceAttrs)
       {
-        iAttrSlot -= rVE.cFaceAttrs;
+        iAttrSlot -= cFaceAttrs;
       }
 
-      if (_viFaceVtxIndices.at (rVE.iFVI + iVtxSlot) == iVtx)
+      if (JT_VFM_ELEM (_viFaceVtxIndices, iFVI + iVtxSlot) == iVtx)
       {
-        return _viFaceAttrIndices.at (rVE.iFAI + iAttrSlot);
+        return JT_VFM_ELEM (_viFaceAttrIndices, iFAI + iAttrSlot);
       }
     }
 
@@ -230,73 +251,37 @@ public:
 
 public:
 
-  struct VtxEnt
-  {
-    uint16_t cVal;   // Vertex valence
-    uint16_t uFlags; // User flags
-    int32_t  iVGrp;  // Vertex group
-    int32_t  iVFI;   // Index into _viVtxFaceIndices of cVal incident faces
-
-    VtxEnt() : cVal (0), uFlags (0), iVGrp (-1), iVFI (-1) {}
-  };
-
   // Number of optimized mask bits.
   static const int32_t cMBits = 64;
 
-  struct FaceEnt
-  {
-    uint16_t cDeg;       // Face degree
-    uint16_t cEmptyDeg;  // Empty degrees (opt for emptyFaceSlots())
-    uint16_t cFaceAttrs; // Number of face attributes
-    uint16_t uFlags;     // User flags
-
-    uint64_t         uAttrMask;   // Degree-ring attribute mask as a UInt64
-    JtDecode_BitVec* pvbAttrMask; // Degree-ring attribute mask as a BitVec
-
-    int32_t iFVI; // Index into _viFaceVtxIndices of cDeg incident vertices
-    int32_t iFAI; // Index into _viFaceAttrIndices of cAttr attributes
-
-    FaceEnt()
-      : cDeg (0), cEmptyDeg (0), cFaceAttrs (0), uFlags (0),
-        uAttrMask (0), pvbAttrMask (NULL), iFVI (-1), iFAI (-1)
-    {
-    }
-
-    FaceEnt (const FaceEnt &rhs)
-      : cDeg (rhs.cDeg), cEmptyDeg (rhs.cEmptyDeg), cFaceAttrs (rhs.cFaceAttrs),
-        uFlags(rhs.uFlags), iFVI (rhs.iFVI), iFAI (rhs.iFAI)
-    {
-      if (cDeg <= cMBits)
-      {
-        pvbAttrMask = NULL;
-        uAttrMask = rhs.uAttrMask;
-      }
-      else
-      {
-        pvbAttrMask = new JtDecode_BitVec (*rhs.pvbAttrMask);
-        uAttrMask = 0;
-      }
-    }
-
-    ~FaceEnt()
-    {
-      delete pvbAttrMask;
-    }
-  };
-
 protected:
 
-  // Subscripted by atom number, the entry contains the vertex valence and
-  // points to the location in _viVtxFaceIndices of valence consecutive
-  // integers that in turn contain the indices of the incident faces
-  // in _vFaceRecs to the vertex.
-  std::vector<VtxEnt> _vVtxEnts;
-
-  // Subscripted by unique vertex record number, the entry contains the
-  // face degree and points to the location in _viFaceVtxIndices of
-  // cDeg consecutive integers that in turn contain the indices of the
-  // vertices incident upon the face, in CCW order, in _vVtxRecs.
-  std::vector<FaceEnt> _vFaceEnts;
+  // Subscripted by atom number, the entries contain the vertex user flags
+  // and the vertex group.
+  std::vector<uint16_t> _vuVtxFlags;
+  std::vector<int32_t>  _viVtxGrp;
+
+  // Subscripted by atom number (numVts() + 1 entries), the entry points to
+  // the location in _viVtxFaceIndices of valence consecutive integers that
+  // in turn contain the indices of the incident faces to the vertex.
+  // The vertex valence is the difference of two subsequent entries.
+  std::vector<int32_t> _viVtxFVI;
+
+  // Subscripted by unique vertex record number, the entries contain the
+  // number of empty degrees (opt for emptyFaceSlots()), the user flags and
+  // the degree-ring attribute mask. The mask of a face with degree exceeding
+  // cMBits is an offset into _vuFaceAttrMaskWords instead.
+  std::vector<uint16_t> _vcFaceEmptyDeg;
+  std::vector<uint16_t> _vuFaceFlags;
+  std::vector<uint64_t> _vuFaceAttrMask;
+
+  // Subscripted by unique vertex record number (numFaces() + 1 entries),
+  // the entries point to the location in _viFaceVtxIndices of cDeg consecutive
+  // integers that in turn contain the indices of the vertices incident upon
+  // the face, in CCW order, and to the location in _viFaceAttrIndices of
+  // the face attributes.
+  std::vector<int32_t> _viFaceFVI;
+  std::vector<int32_t> _viFaceFAI;
 
   // Combined storage for all vertices.
   std::vector<int32_t> _viVtxFaceIndices;
@@ -306,95 +291,93 @@ protected:
 
   // Combined storage for all face attribute record identifiers
   std::vector<int32_t> _viFaceAttrIndices;
+
+  // Combined storage for the attribute masks of faces with degree exceeding cMBits
+  std::vector<uint32_t> _vuFaceAttrMaskWords;
 };
 
 bool JtDecode_DualVFMesh::clear()
 {
-  _vVtxEnts.clear();
-  _vFaceEnts.clear();
+  _vuVtxFlags.clear();
+  _viVtxGrp.clear();
+  _viVtxFVI.assign (1, 0);
+  _vcFaceEmptyDeg.clear();
+  _vuFaceFlags.clear();
+  _vuFaceAttrMask.clear();
+  _viFaceFVI.assign (1, 0);
+  _viFaceFAI.assign (1, 0);
   _viVtxFaceIndices.clear();
   _viFaceVtxIndices.clear();
   _viFaceAttrIndices.clear();
+  _vuFaceAttrMaskWords.clear();
 
   return true;
 }
 
+void JtDecode_DualVFMesh::reserve (int32_t nVts,
+                                   int32_t nVtxFaces,
+                                   int32_t nFaces,
+                                   int32_t nFaceVts,
+                                   int32_t nAttrs,
+                                   int32_t nMaskWords)
+{
+  _vuVtxFlags.reserve (nVts);
+  _viVtxGrp.reserve (nVts);
+  _viVtxFVI.reserve (nVts + 1);
+  _vcFaceEmptyDeg.reserve (nFaces);
+  _vuFaceFlags.reserve (nFaces);
+  _vuFaceAttrMask.reserve (nFaces);
+  _viFaceFVI.reserve (nFaces + 1);
+  _viFaceFAI.reserve (nFaces + 1);
+  _viVtxFaceIndices.reserve (nVtxFaces);
+  _viFaceVtxIndices.reserve (nFaceVts);
+  _viFaceAttrIndices.reserve (nAttrs);
+  _vuFaceAttrMaskWords.reserve (nMaskWords);
+}
+
 bool JtDecode_DualVFMesh::isValidVtx (int32_t iVtx) const
 {
-  bool bRet = false;
-  if (iVtx >= 0 && iVtx < (int32_t)_vVtxEnts.size())
-  {
-    const VtxEnt &rFE = _vVtxEnts[iVtx];
-    bRet = (rFE.cVal != 0);
-  }
-  return bRet;
+  return iVtx >= 0 && iVtx < numVts() && valence (iVtx) != 0;
 }
 
 bool JtDecode_DualVFMesh::newVtx (int32_t iVtx, int32_t iValence, uint16_t uFlags)
 {
   // for debug
-  Standard_ASSERT (iVtx == (int32_t)_vVtxEnts.size(), "Error", return false);
+  Standard_ASSERT (iVtx == numVts(), "Error", return false);
 
-  _vVtxEnts.push_back (VtxEnt());
-  VtxEnt& rFE = _vVtxEnts.back();
-  if (rFE.cVal != iValence)
-  {
-    rFE.cVal = static_cast<uint16_t> (iValence);
-    rFE.uFlags = uFlags;
-    rFE.iVFI = static_cast<int32_t>(_viVtxFaceIndices.size());
-    _viVtxFaceIndices.resize (rFE.iVFI + iValence);
-    for (int32_t i = rFE.iVFI; i < rFE.iVFI + iValence; ++i)
-      _viVtxFaceIndices[i] = -1;
-  }
+  const int32_t iVFI = _viVtxFVI.back();
+  _vuVtxFlags.push_back (iValence != 0 ? uFlags : 0);
+  _viVtxGrp.push_back (-1);
+  _viVtxFVI.push_back (iVFI + iValence);
+  _viVtxFaceIndices.resize (iVFI + iValence, -1);
   return true;
 }
 
 bool JtDecode_DualVFMesh::setVtxGrp (int32_t iVtx, int32_t iVGrp)
 {
-  VtxEnt &rFE = _vVtxEnts[iVtx];
-  rFE.iVGrp = iVGrp;
+  JT_VFM_ELEM (_viVtxGrp, iVtx) = iVGrp;
   return true;
 }
 
 bool JtDecode_DualVFMesh::setVtxFlags (int32_t iVtx, uint16_t uFlags)
 {
-  VtxEnt &rFE = _vVtxEnts[iVtx];
-  rFE.uFlags = uFlags;
+  JT_VFM_ELEM (_vuVtxFlags, iVtx) = uFlags;
   return true;
 }
 
 int32_t JtDecode_DualVFMesh::vtxGrp (int32_t iVtx) const
 {
-  int32_t u = -1;
-  if (iVtx >= 0 && iVtx < (int32_t)_vVtxEnts.size())
-  {
-    const VtxEnt &rFE = _vVtxEnts[iVtx];
-    u = rFE.iVGrp;
-  }
-  return u;
+  return (iVtx >= 0 && iVtx < numVts()) ? _viVtxGrp[iVtx] : -1;
 }
 
 uint16_t JtDecode_DualVFMesh::vtxFlags (int32_t iVtx) const
 {
-  uint16_t u = 0;
-  if (iVtx >= 0 && iVtx < (int32_t)_vVtxEnts.size())
-  {
-    const VtxEnt &rFE = _vVtxEnts[iVtx];
-    u = rFE.uFlags;
-  }
-
-  return u;
+  return (iVtx >= 0 && iVtx < numVts()) ? _vuVtxFlags[iVtx] : 0;
 }
 
 bool JtDecode_DualVFMesh::isValidFace (int32_t iFace) const
 {
-  bool bRet = false;
-  if (iFace >= 0 && iFace < (int32_t)_vFaceEnts.size())
-  {
-    const FaceEnt &rVE = _vFaceEnts[iFace];
-    bRet = (rVE.cDeg != 0);
-  }
-  return bRet;
+  return iFace >= 0 && iFace < numFaces() && degree (iFace) != 0;
 }
 
 bool JtDecode_DualVFMesh::newFace (int32_t  iFace,
@@ -404,67 +387,44 @@ bool JtDecode_DualVFMesh::newFace (int32_t  iFace,
                                    uint16_t uFlags)
 {
   // for debug
-  Standard_ASSERT ((int32_t)_vFaceEnts.size() == iFace, "Error", return false);
-
-  _vFaceEnts.push_back (FaceEnt());
-  FaceEnt& rVE = _vFaceEnts.back();
-
-  if (rVE.cDeg != cDegree)
-  {
-    rVE.cDeg       = (uint16_t)cDegree;
-    rVE.cEmptyDeg  = (uint16_t)cDegree;
-    rVE.cFaceAttrs = (uint16_t)cFaceAttrs;
-    rVE.uFlags     = uFlags;
-    rVE.uAttrMask  = uFaceAttrMask;
-    rVE.iFVI       = static_cast<int32_t>(_viFaceVtxIndices.size());
-    rVE.iFAI       = static_cast<int32_t>(_viFaceAttrIndices.size());
+  Standard_ASSERT (numFaces() == iFace, "Error", return false);
 
-    _viFaceVtxIndices.resize (rVE.iFVI + cDegree);
+  const int32_t iFVI = _viFaceFVI.back();
+  const int32_t iFAI = _viFaceFAI.back();
+  cFaceAttrs = Max (cFaceAttrs, 0);
 
-    if (cFaceAttrs > 0)
-      _viFaceAttrIndices.resize (rVE.iFAI + cFaceAttrs);
+  _vcFaceEmptyDeg.push_back ((uint16_t)cDegree);
+  _vuFaceFlags   .push_back (uFlags);
+  _vuFaceAttrMask.push_back (uFaceAttrMask);
+  _viFaceFVI     .push_back (iFVI + cDegree);
+  _viFaceFAI     .push_back (iFAI + cFaceAttrs);
 
-    for (int32_t i = rVE.iFVI; i < rVE.iFVI + cDegree; ++i)
-      _viFaceVtxIndices[i] = -1;
-
-    for (int32_t i = rVE.iFAI ; i < rVE.iFAI + cFaceAttrs; ++i)
-      _viFaceAttrIndices[i] = -1;
-  }
+  _viFaceVtxIndices .resize (iFVI + cDegree,    -1);
+  _viFaceAttrIndices.resize (iFAI + cFaceAttrs, -1);
 
   return true;
 }
 
-bool JtDecode_DualVFMesh::newFace (int32_t iFace,
-                                   int32_t cDegree,
-                                   int32_t cFaceAttrs,
-                                   const JtDecode_BitVec* pvbFaceAttrMask,
-                                   uint16_t uFlags)
+bool JtDecode_DualVFMesh::newFace (int32_t         iFace,
+                                   int32_t         cDegree,
+                                   int32_t         cFaceAttrs,
+                                   const uint32_t* puFaceAttrMask,
+                                   int32_t         nMaskWords,
+                                   uint16_t        uFlags)
 {
-  Standard_ASSERT ((int32_t)_vFaceEnts.size() == iFace, "Error", return false);
+  // Append the mask words padded with zeros to cover all degree-ring slots
+  const size_t iMaskPos = _vuFaceAttrMaskWords.size();
+  const int32_t nWords = (cDegree + JtDecode_BitVec::cWordBits - 1) >> JtDecode_BitVec::cBitsLog2;
+  nMaskWords = Min (Max (nMaskWords, 0), nWords);
 
-  _vFaceEnts.push_back (FaceEnt());
-  FaceEnt& rVE = _vFaceEnts.back();
+  _vuFaceAttrMaskWords.resize (iMaskPos + nWords, 0);
+  if (nMaskWords > 0)
+    memcpy (&_vuFaceAttrMaskWords[iMaskPos], puFaceAttrMask, nMaskWords * sizeof (uint32_t));
 
-  if (rVE.cDeg != cDegree)
+  if (!newFace (iFace, cDegree, cFaceAttrs, static_cast<uint64_t> (iMaskPos), uFlags))
   {
-    rVE.cDeg        = (uint16_t)cDegree;
-    rVE.cEmptyDeg   = (uint16_t)cDegree;
-    rVE.cFaceAttrs  = (uint16_t)cFaceAttrs;
-    rVE.uFlags      = uFlags;
-    rVE.pvbAttrMask = new JtDecode_BitVec (*pvbFaceAttrMask);
-    rVE.iFVI        = static_cast<int32_t>(_viFaceVtxIndices.size());
-    rVE.iFAI        = static_cast<int32_t>(_viFaceAttrIndices.size());
-
-    _viFaceVtxIndices.resize (rVE.iFVI + cDegree);
-
-    if (cFaceAttrs > 0)
-      _viFaceAttrIndices.resize (rVE.iFAI + cFaceAttrs);
-
-    for (int32_t i = rVE.iFVI; i < rVE.iFVI + cDegree; ++i)
-      _viFaceVtxIndices[i] = -1;
-    
-    for (int32_t i = rVE.iFAI; i < rVE.iFAI + cFaceAttrs; ++i)
-      _viFaceAttrIndices[i] = -1;
+    _vuFaceAttrMaskWords.resize (iMaskPos);
+    return false;
   }
 
   return true;
@@ -472,43 +432,29 @@ bool JtDecode_DualVFMesh::newFace (int32_t iFace,
 
 bool JtDecode_DualVFMesh::setFaceFlags (int32_t iFace, uint16_t uFlags)
 {
-  FaceEnt &rVE = _vFaceEnts[iFace];
-  rVE.uFlags = uFlags;
+  JT_VFM_ELEM (_vuFaceFlags, iFace) = uFlags;
   return true;
 }
 
 uint16_t JtDecode_DualVFMesh::faceFlags (int32_t iFace) const
 {
-  uint16_t u = 0;
-  if (iFace >= 0 && iFace < (int32_t)_vFaceEnts.size())
-  {
-    const FaceEnt &rVE = _vFaceEnts[iFace];
-    u = rVE.uFlags;
-  }
-  return u;
+  return (iFace >= 0 && iFace < numFaces()) ? _vuFaceFlags[iFace] : 0;
 }
 
 bool JtDecode_DualVFMesh::setFaceAttr (int32_t iFace,
                                        int32_t iAttrSlot,
                                        int32_t iFaceAttr)
 {
-  FaceEnt &rVE = _vFaceEnts[iFace];
-  int32_t *paiFAI = &(_viFaceAttrIndices.front());
-  paiFAI[rVE.iFAI + iAttrSlot] = iFaceAttr;
+  JT_VFM_ELEM (_viFaceAttrIndices, JT_VFM_ELEM (_viFaceFAI, iFace) + iAttrSlot) = iFaceAttr;
   return true;
 }
 
 int32_t JtDecode_DualVFMesh::faceAttr (int32_t iFace, int32_t iAttrSlot) const
 {
   int32_t u = 0;
-  if (iFace >= 0 && iFace < (int32_t)_vFaceEnts.size())
+  if (iFace >= 0 && iFace < numFaces() && iAttrSlot >= 0 && iAttrSlot < numAttrs (iFace))
   {
-    const FaceEnt &rVE = _vFaceEnts[iFace];
-    if (iAttrSlot >= 0 && iAttrSlot < rVE.cDeg)
-    {
-      const int32_t* paiFAI = &(_viFaceAttrIndices.front());
-      u = paiFAI[rVE.iFAI + iAttrSlot];
-    }
+    u = _viFaceAttrIndices[_viFaceFAI[iFace] + iAttrSlot];
   }
   return u;
 }
@@ -517,8 +463,7 @@ int32_t JtDecode_DualVFMesh::faceAttr (int32_t iFace, int32_t iAttrSlot) const
 // face slot iFaceSlot
 bool JtDecode_DualVFMesh::setVtxFace (int32_t iVtx, int32_t iFaceSlot, int32_t iFace)
 {
-  VtxEnt &rFE = _vVtxEnts[iVtx];
-  _viVtxFaceIndices[rFE.iVFI + iFaceSlot] = iFace;
+  JT_VFM_ELEM (_viVtxFaceIndices, JT_VFM_ELEM (_viVtxFVI, iVtx) + iFaceSlot) = iFace;
   return true;
 }
 
@@ -526,10 +471,9 @@ bool JtDecode_DualVFMesh::setVtxFace (int32_t iVtx, int32_t iFaceSlot, int32_t i
 // vertex slot iVtxSlot
 bool JtDecode_DualVFMesh::setFaceVtx (int32_t iFace, int32_t iVtxSlot, int32_t iVtx)
 {
-  FaceEnt &rVE = _vFaceEnts[iFace];
-  int32_t *paiFVI = &(_viFaceVtxIndices.front());
-  rVE.cEmptyDeg -= (paiFVI[rVE.iFVI + iVtxSlot] != iVtx);
-  paiFVI[rVE.iFVI + iVtxSlot] = iVtx;
+  int32_t& rFaceVtx = JT_VFM_ELEM (_viFaceVtxIndices, JT_VFM_ELEM (_viFaceFVI, iFace) + iVtxSlot);
+  JT_VFM_ELEM (_vcFaceEmptyDeg, iFace) -= (rFaceVtx != iVtx);
+  rFaceVtx = iVtx;
   return true;
 }
 
@@ -538,19 +482,16 @@ bool JtDecode_DualVFMesh::setFaceVtx (int32_t iFace, int32_t iVtxSlot, int32_t i
 // or -1 if iTargVtx is not found.
 int32_t JtDecode_DualVFMesh::findVtxSlot (int32_t iFace, int32_t iTargVtx) const
 {
-  const FaceEnt &rVE = _vFaceEnts[iFace];
-  const int32_t *const pFaceVtxIndices = &(_viFaceVtxIndices.front()) + rVE.iFVI;
-  int32_t cDeg = rVE.cDeg;
-  int32_t iSlot = -1;
-  for (int32_t iVtxSlot = 0 ; iVtxSlot < cDeg ; iVtxSlot++)
+  const int32_t iFVI = JT_VFM_ELEM (_viFaceFVI, iFace);
+  const int32_t cDeg = degree (iFace);
+  for (int32_t iVtxSlot = 0; iVtxSlot < cDeg; iVtxSlot++)
   {
-    if (pFaceVtxIndices[iVtxSlot] == iTargVtx)
+    if (_viFaceVtxIndices[iFVI + iVtxSlot] == iTargVtx)
     {
-      iSlot = iVtxSlot;
-      break;
+      return iVtxSlot;
     }
   }
-  return iSlot;
+  return -1;
 }
 
 // Searches the list of incident faces to vertex iVtx for
@@ -558,11 +499,11 @@ int32_t JtDecode_DualVFMesh::findVtxSlot (int32_t iFace, int32_t iTargVtx) const
 // or -1 if iTargFace is not found.
 int32_t JtDecode_DualVFMesh::findFaceSlot (int32_t iVtx, int32_t iTargFace) const
 {
-  const VtxEnt &rFE = _vVtxEnts[iVtx];
-  const int32_t* const pVtxFaceIndices = &(_viVtxFaceIndices.front()) + rFE.iVFI;
-  for (int32_t iFaceSlot = 0; iFaceSlot < rFE.cVal; ++iFaceSlot)
+  const int32_t iVFI = JT_VFM_ELEM (_viVtxFVI, iVtx);
+  const int32_t cVal = valence (iVtx);
+  for (int32_t iFaceSlot = 0; iFaceSlot < cVal; ++iFaceSlot)
   {
-    if (pVtxFaceIndices[iFaceSlot] == iTargFace)
+    if (_viVtxFaceIndices[iVFI + iFaceSlot] == iTargFace)
     {
       return iFaceSlot;
     }
@@ -690,6 +631,10 @@ void JtDecode_MeshCodec::run()
   _pDstVFM->clear();
   clear();
 
+  // Size the output mesh up front to avoid reallocations while decoding
+  if (_pTMC != NULL)
+    _pTMC->_reserveVFMesh (vfm());
+
   // Co/dec connected mesh components one at a time
   bool bFoundComponent = true;
   while (bFoundComponent)
@@ -1115,16 +1060,16 @@ int32_t JtDecode_MeshDecoder::ioFace (int32_t iVtx, int32_t /*jFSlot*/)
     }
     else
     {
-      JtDecode_BitVec vbAttrMask;
-      _pTMC->_nextAttrMaskSymbol (&vbAttrMask, cDeg);
+      int32_t nMaskWords = 0;
+      const uint32_t* puAttrMask = _pTMC->_nextAttrMaskSymbol (cDeg, nMaskWords);
 
-      for (int32_t i = 0 ; i < cDeg ; ++i)
+      for (int32_t i = 0 ; i < Min (cDeg, nMaskWords * JtDecode_BitVec::cWordBits) ; ++i)
       {
-        if (vbAttrMask.Test (i))
+        if ((puAttrMask[i >> JtDecode_BitVec::cBitsLog2] & (1u << (i & 0x1F))) != 0)
           nFaceAttrs++;
       }
 
-      _pDstVFM->newFace (iFace, cDeg, nFaceAttrs, &vbAttrMask, 0);
+      _pDstVFM->newFace (iFace, cDeg, nFaceAttrs, puAttrMask, nMaskWords, 0);
     }
 
     // Error check for a corrupt degree or attrmask
@@ -1263,8 +1208,12 @@ public:
         myStartIndices[iFace] = -1;
     }
 
-    if (myVertexIndices) myVertexIndices->Allocate (numIndices);
-    if (myNormalIndices) myNormalIndices->Allocate (numIndices);
+    {
+      // The output indices outlive the decoding arena if any
+      JtData_Arena::Scope aHeapScope (0L);
+      if (myVertexIndices) myVertexIndices->Allocate (numIndices);
+      if (myNormalIndices) myNormalIndices->Allocate (numIndices);
+    }
 
     JtData_Parallel::For ((int32_t)0, numFaces, *this);
   }
@@ -1404,20 +1353,66 @@ int64_t JtDecode_MeshCoderDriver::_nextAttrMaskSymbol (int32_t iCCntx)
   return eSym;
 }
 
-void JtDecode_MeshCoderDriver::_nextAttrMaskSymbol (JtDecode_BitVec* iopvbAttrMask, int cDegree)
+//! Next large attr mask symbol; returns the words of the mask available in the
+//! symbol stream and their number, which may be less than the degree requires
+const uint32_t* JtDecode_MeshCoderDriver::_nextAttrMaskSymbol (int32_t cDegree, int32_t& onWords)
+{
+  onWords = 0;
+  if (_iAttrMaskLrgReadPos >= _vuOutAttrMasksLrg.Count())
+    return NULL;
+
+  const int32_t nWords = (cDegree + JtDecode_BitVec::cWordBits - 1) >> JtDecode_BitVec::cBitsLog2;
+  const uint32_t* pu = &_vuOutAttrMasksLrg[_iAttrMaskLrgReadPos];
+  onWords = Min (nWords, _vuOutAttrMasksLrg.Count() - _iAttrMaskLrgReadPos);
+  _iAttrMaskLrgReadPos += nWords;
+  return pu;
+}
+
+//! Number of set bits in a mask
+static inline int32_t bitCount (uint64_t theMask)
 {
-  if (_iAttrMaskLrgReadPos < _vuOutAttrMasksLrg.Count())
+  int32_t aCount = 0;
+  for (; theMask; theMask &= theMask - 1)
+    aCount++;
+  return aCount;
+}
+
+//! Reserves the output mesh storage using the symbol counts: every valence
+//! symbol makes a vertex, every non-zero degree symbol makes a face and
+//! every set attribute mask bit makes a face attribute.
+void JtDecode_MeshCoderDriver::_reserveVFMesh (JtDecode_DualVFMesh* pVFM) const
+{
+  int32_t nVtxFaces = 0;
+  for (int32_t i = 0; i < _vviOutValSyms.Count(); ++i)
+    nVtxFaces += Max (_vviOutValSyms[i], 0);
+
+  int32_t nFaces = 0, nFaceVts = 0;
+  for (int32_t iCCntx = 0; iCCntx < 8; ++iCCntx)
   {
-    iopvbAttrMask->SetLength (cDegree);
-    uint32_t* pu = iopvbAttrMask->Data();
-    int32_t nWords = (cDegree + JtDecode_BitVec::cWordBits - 1) >> JtDecode_BitVec::cBitsLog2;
-    memcpy (pu, &_vuOutAttrMasksLrg[_iAttrMaskLrgReadPos], nWords * sizeof (uint32_t));
-    _iAttrMaskLrgReadPos += nWords;
+    const Jt_VecI32& aSyms = _viOutDegSyms[iCCntx];
+    for (int32_t i = 0; i < aSyms.Count(); ++i)
+    {
+      nFaces   += (aSyms[i] > 0);
+      nFaceVts += Max (aSyms[i], 0);
+    }
   }
-  else
+
+  int32_t nAttrs = 0;
+  for (int32_t iCCntx = 0; iCCntx < 8; ++iCCntx)
   {
-    iopvbAttrMask->SetLength (0);
+    const Jt_VecI32& aMasks = _vvuOutAttrMasks[iCCntx];
+    for (int32_t i = 0; i < aMasks.Count(); ++i)
+      nAttrs += bitCount (static_cast<uint32_t> (aMasks[i]));
   }
+  for (int32_t i = 0; i < _faceAttributeMask8_4.Count(); ++i)
+    nAttrs += bitCount (static_cast<uint32_t> (_faceAttributeMask8_4[i]));
+  for (int32_t i = 0; i < _faceAttributeMask8_30.Count(); ++i)
+    nAttrs += bitCount (static_cast<uint32_t> (_faceAttributeMask8_30[i]));
+  for (int32_t i = 0; i < _vuOutAttrMasksLrg.Count(); ++i)
+    nAttrs += bitCount (_vuOutAttrMasksLrg[i]);
+
+  pVFM->reserve (_vviOutValSyms.Count(), nVtxFaces, nFaces, nFaceVts,
+                 Min (nAttrs, nFaceVts), _vuOutAttrMasksLrg.Count());
 }
 
 //! Split face symbol
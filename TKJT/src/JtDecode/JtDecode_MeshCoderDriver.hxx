@@ -24,7 +24,6 @@
 
 class JtDecode_MeshDecoder;
 class JtDecode_DualVFMesh;
-class JtDecode_BitVec;
 
 //! Class performing decoding of dual mesh into primal mesh.
 class JtDecode_MeshCoderDriver
@@ -67,10 +66,11 @@ public:
   int32_t _nextFGrpSymbol();
   int32_t _nextVtxFlagSymbol();
   int64_t _nextAttrMaskSymbol (int32_t iCCntx);
-  void    _nextAttrMaskSymbol (JtDecode_BitVec* iopvbAttrMask, int cDegree);
+  const uint32_t* _nextAttrMaskSymbol (int32_t cDegree, int32_t& onWords);
   int32_t _nextSplitFaceSymbol();
   int32_t _nextSplitPosSymbol();
   int32_t _faceCntxt (int32_t iVtx, JtDecode_DualVFMesh* pVFM);
+  void    _reserveVFMesh (JtDecode_DualVFMesh* pVFM) const;
 
 private:
   class decodeVFMesh;
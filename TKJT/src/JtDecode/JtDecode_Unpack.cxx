@@ -16,6 +16,23 @@
 
 #include <JtDecode_Unpack.hxx>
 
+// SSE2 is always available on x86-64, AVX2 is used if supported by the running CPU
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define JT_UNPACK_SSE2
+  #include <emmintrin.h>
+
+  #if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+    #define JT_UNPACK_AVX2
+    #define JT_TARGET_AVX2 __attribute__ ((target ("avx2")))
+    #include <immintrin.h>
+  #elif defined(_MSC_VER) && _MSC_VER >= 1700
+    #define JT_UNPACK_AVX2
+    #define JT_TARGET_AVX2
+    #include <immintrin.h>
+    #include <intrin.h>
+  #endif
+#endif
+
 // Internal data types
 typedef JtData_VectorRef<int32_t, int32_t> Values; // reference to array of values
 typedef Values::SizeType I; // index type
@@ -54,6 +71,233 @@ T PredStripIdx (I  , T   , T v2, T v4) { T d = v2 - v4;
 T Add (T predicted, T residual) { return predicted + residual; }
 T Xor (T predicted, T residual) { return predicted ^ residual; }
 
+#ifdef JT_UNPACK_SSE2
+
+// Vectorized unpacking.
+// Lag and Xor predictors turn the residuals into a running sum (or xor) of every
+// (Stride = 1) or every other (Stride = 2) value, computed as a prefix sum within
+// a block of vector lanes plus a carry from the previous block.
+// Stride predictors are the same running sums applied twice:
+// first to get the differences between the values, then to get the values.
+
+// Combining operations
+struct AddOp
+{
+  static T       Scalar (T a, T b)             { return a + b; }
+  static __m128i Vector (__m128i a, __m128i b) { return _mm_add_epi32 (a, b); }
+#ifdef JT_UNPACK_AVX2
+  JT_TARGET_AVX2
+  static __m256i Vector (__m256i a, __m256i b) { return _mm256_add_epi32 (a, b); }
+#endif
+};
+
+struct XorOp
+{
+  static T       Scalar (T a, T b)             { return a ^ b; }
+  static __m128i Vector (__m128i a, __m128i b) { return _mm_xor_si128 (a, b); }
+#ifdef JT_UNPACK_AVX2
+  JT_TARGET_AVX2
+  static __m256i Vector (__m256i a, __m256i b) { return _mm256_xor_si256 (a, b); }
+#endif
+};
+
+// Scalar running sum of the values starting from the given index,
+// the carries are the values preceding the first one (even and odd).
+template <class Op, int Stride>
+static void prefixScalar (T* theData, I theFrom, I theCount, T theCarry0, T theCarry1)
+{
+  for (I i = theFrom; i < theCount; i++)
+  {
+    T aPrev = i >= Stride ? theData[i - Stride] : (i == 0 ? theCarry0 : theCarry1);
+    theData[i] = Op::Scalar (aPrev, theData[i]);
+  }
+}
+
+// SSE2 running sum, processes 4 values per step
+template <class Op, int Stride>
+static void prefixSSE2 (T* theData, I theCount, T theCarry0, T theCarry1)
+{
+  __m128i aCarry = _mm_setr_epi32 (theCarry0, theCarry1, theCarry0, theCarry1);
+
+  I i = 0;
+  for (; i + 4 <= theCount; i += 4)
+  {
+    __m128i* aPtr = reinterpret_cast <__m128i*> (theData + i);
+    __m128i  aSum = _mm_loadu_si128 (aPtr);
+    if (Stride == 1)
+      aSum = Op::Vector (aSum, _mm_slli_si128 (aSum, 4));
+    aSum = Op::Vector (aSum, _mm_slli_si128 (aSum, 8));
+    aSum = Op::Vector (aSum, aCarry);
+    _mm_storeu_si128 (aPtr, aSum);
+
+    aCarry = Stride == 1 ? _mm_shuffle_epi32 (aSum, _MM_SHUFFLE (3, 3, 3, 3))
+                         : _mm_shuffle_epi32 (aSum, _MM_SHUFFLE (3, 2, 3, 2));
+  }
+
+  prefixScalar<Op, Stride> (theData, i, theCount, theCarry0, theCarry1);
+}
+
+#ifdef JT_UNPACK_AVX2
+
+// AVX2 running sum, processes 8 values per step
+template <class Op, int Stride>
+JT_TARGET_AVX2
+static void prefixAVX2 (T* theData, I theCount, T theCarry0, T theCarry1)
+{
+  const __m256i aLastIdx = Stride == 1 ? _mm256_set1_epi32 (7)
+                                       : _mm256_setr_epi32 (6, 7, 6, 7, 6, 7, 6, 7);
+  const __m256i aHalfIdx = Stride == 1 ? _mm256_set1_epi32 (3)
+                                       : _mm256_setr_epi32 (2, 3, 2, 3, 2, 3, 2, 3);
+  __m256i aCarry = _mm256_setr_epi32 (theCarry0, theCarry1, theCarry0, theCarry1,
+                                      theCarry0, theCarry1, theCarry0, theCarry1);
+
+  I i = 0;
+  for (; i + 8 <= theCount; i += 8)
+  {
+    __m256i* aPtr = reinterpret_cast <__m256i*> (theData + i);
+    __m256i  aSum = _mm256_loadu_si256 (aPtr);
+
+    // sums within 128-bit halves
+    if (Stride == 1)
+      aSum = Op::Vector (aSum, _mm256_slli_si256 (aSum, 4));
+    aSum = Op::Vector (aSum, _mm256_slli_si256 (aSum, 8));
+
+    // propagate the lower half sums to the upper half
+    __m256i aLowSum = _mm256_permutevar8x32_epi32 (aSum, aHalfIdx);
+    aSum = Op::Vector (aSum, _mm256_blend_epi32 (_mm256_setzero_si256(), aLowSum, 0xF0));
+
+    aSum = Op::Vector (aSum, aCarry);
+    _mm256_storeu_si256 (aPtr, aSum);
+
+    aCarry = _mm256_permutevar8x32_epi32 (aSum, aLastIdx);
+  }
+
+  prefixScalar<Op, Stride> (theData, i, theCount, theCarry0, theCarry1);
+}
+
+// Check if the CPU and OS support AVX2
+static Standard_Boolean hasAVX2()
+{
+#ifdef _MSC_VER
+  int anInfo[4];
+  __cpuid (anInfo, 0);
+  if (anInfo[0] < 7)
+    return Standard_False;
+
+  // check for AVX and enabled saving of YMM registers by OS
+  __cpuid (anInfo, 1);
+  if ((anInfo[2] & (1 << 27)) == 0 || (anInfo[2] & (1 << 28)) == 0
+   || (_xgetbv (0) & 6) != 6)
+    return Standard_False;
+
+  __cpuidex (anInfo, 7, 0);
+  return (anInfo[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports ("avx2") != 0;
+#endif
+}
+
+#endif // JT_UNPACK_AVX2
+
+#endif // JT_UNPACK_SSE2
+
+// Best instruction set supported by the CPU
+static JtDecode_UnpackLevel bestLevel()
+{
+#if defined(JT_UNPACK_AVX2)
+  return hasAVX2() ? JtDecode_UnpackLevel_AVX2 : JtDecode_UnpackLevel_SSE2;
+#elif defined(JT_UNPACK_SSE2)
+  return JtDecode_UnpackLevel_SSE2;
+#else
+  return JtDecode_UnpackLevel_Scalar;
+#endif
+}
+
+static const JtDecode_UnpackLevel THE_BEST_LEVEL = bestLevel();
+
+// Selected instruction set
+static JtDecode_UnpackLevel THE_LEVEL = THE_BEST_LEVEL;
+
+// Select the instruction set, lowered to the supported one
+JtDecode_UnpackLevel JtDecode_Unpack_SetLevel (const JtDecode_UnpackLevel theLevel)
+{
+  THE_LEVEL = theLevel < THE_BEST_LEVEL ? theLevel : THE_BEST_LEVEL;
+  return THE_LEVEL;
+}
+
+#ifdef JT_UNPACK_SSE2
+
+// Running sum with runtime dispatch
+template <class Op, int Stride>
+static void prefix (T* theData, I theCount, T theCarry0, T theCarry1)
+{
+#ifdef JT_UNPACK_AVX2
+  if (THE_LEVEL == JtDecode_UnpackLevel_AVX2)
+  {
+    prefixAVX2<Op, Stride> (theData, theCount, theCarry0, theCarry1);
+    return;
+  }
+#endif
+  prefixSSE2<Op, Stride> (theData, theCount, theCarry0, theCarry1);
+}
+
+// Lag1, Lag2, Xor1, Xor2 unpacker
+template <class Op, int Stride>
+static void unpackLag (Values theValues)
+{
+  if (theValues.Count() <= 4)
+    return;
+
+  T* aData = theValues.Data();
+  prefix<Op, Stride> (aData + 4, theValues.Count() - 4, aData[4 - Stride], aData[3]);
+}
+
+// Stride1, Stride2 unpacker
+template <int Stride>
+static void unpackStride (Values theValues)
+{
+  if (theValues.Count() <= 4)
+    return;
+
+  // differences between the values, then the values
+  T* aData = theValues.Data();
+  prefix<AddOp, Stride> (aData + 4, theValues.Count() - 4,
+                         aData[4 - Stride] - aData[4 - 2 * Stride], aData[3] - aData[3 - Stride]);
+  prefix<AddOp, Stride> (aData + 4, theValues.Count() - 4, aData[4 - Stride], aData[3]);
+}
+
+// Ramp unpacker, has no dependency between the values
+static void unpackRamp (Values theValues)
+{
+  T* aData = theValues.Data();
+  for (I i = 4; i < theValues.Count(); i++)
+    aData[i] += i;
+}
+
+// Vectorized or scalar unpacker depending on the selected instruction set
+template <void Vectorized (Values), class Scalar>
+static void unpack (Values theValues)
+{
+  if (THE_LEVEL != JtDecode_UnpackLevel_Scalar)
+    Vectorized (theValues);
+  else
+    (Scalar) (theValues);
+}
+
+// Unpackers
+void JtDecode_Unpack_Null    (Values) {}
+void JtDecode_Unpack_Lag1    (Values theValues) { unpack<unpackLag<AddOp, 1>, Unpack<PredLag1   , Add> > (theValues); }
+void JtDecode_Unpack_Lag2    (Values theValues) { unpack<unpackLag<AddOp, 2>, Unpack<PredLag2   , Add> > (theValues); }
+void JtDecode_Unpack_Xor1    (Values theValues) { unpack<unpackLag<XorOp, 1>, Unpack<PredLag1   , Xor> > (theValues); }
+void JtDecode_Unpack_Xor2    (Values theValues) { unpack<unpackLag<XorOp, 2>, Unpack<PredLag2   , Xor> > (theValues); }
+void JtDecode_Unpack_Ramp    (Values theValues) { unpack<unpackRamp         , Unpack<PredRamp   , Add> > (theValues); }
+void JtDecode_Unpack_Stride1 (Values theValues) { unpack<unpackStride<1>    , Unpack<PredStride1, Add> > (theValues); }
+void JtDecode_Unpack_Stride2 (Values theValues) { unpack<unpackStride<2>    , Unpack<PredStride2, Add> > (theValues); }
+void JtDecode_Unpack_StripIdx(Values theValues) { (Unpack<PredStripIdx, Add>) (theValues); }
+
+#else
+
 // Unpackers
 void JtDecode_Unpack_Null    (Values) {}
 void JtDecode_Unpack_Lag1    (Values theValues) { (Unpack<PredLag1    , Add>) (theValues); }
@@ -64,3 +308,5 @@ void JtDecode_Unpack_Ramp    (Values theValues) { (Unpack<PredRamp    , Add>) (t
 void JtDecode_Unpack_Stride1 (Values theValues) { (Unpack<PredStride1 , Add>) (theValues); }
 void JtDecode_Unpack_Stride2 (Values theValues) { (Unpack<PredStride2 , Add>) (theValues); }
 void JtDecode_Unpack_StripIdx(Values theValues) { (Unpack<PredStripIdx, Add>) (theValues); }
+
+#endif // JT_UNPACK_SSE2
@@ -21,7 +21,7 @@
 
 typedef void JtDecode_Unpack (JtData_VectorRef<int32_t, int32_t> theValues);
 
-JtDecode_Unpack
+Standard_EXPORT JtDecode_Unpack
   JtDecode_Unpack_Null,
   JtDecode_Unpack_Lag1,
   JtDecode_Unpack_Lag2,
@@ -32,4 +32,17 @@ JtDecode_Unpack
   JtDecode_Unpack_Stride2,
   JtDecode_Unpack_StripIdx;
 
+//! Instruction set used by the unpackers.
+enum JtDecode_UnpackLevel
+{
+  JtDecode_UnpackLevel_Scalar, //!< scalar code only
+  JtDecode_UnpackLevel_SSE2,   //!< SSE2 running sums
+  JtDecode_UnpackLevel_AVX2    //!< AVX2 running sums
+};
+
+//! Select the instruction set of the unpackers, lowered to the best one
+//! supported by the CPU (used by default); return the selected level.
+//! Not thread-safe; intended for testing the vectorized unpackers.
+Standard_EXPORT JtDecode_UnpackLevel JtDecode_Unpack_SetLevel (const JtDecode_UnpackLevel theLevel);
+
 #endif
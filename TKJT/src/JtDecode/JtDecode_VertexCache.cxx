@@ -0,0 +1,260 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#include <JtDecode_VertexCache.hxx>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  //! Size of the LRU cache simulated by the triangle reordering.
+  const int32_t THE_LRU_SIZE = static_cast <int32_t> (JtDecode_VertexCache::DefaultCacheSize);
+
+  //! Score of a vertex depending on its position in the LRU cache
+  //! (-1 if it is not there) and the number of its triangles not emitted yet.
+  inline float vertexScore (const int32_t theCachePos, const int32_t theNbRemaining)
+  {
+    if (theNbRemaining == 0)
+      return -1.f;
+
+    float aScore = 0.f;
+    if (theCachePos >= 0)
+    {
+      // Vertices of the last triangle get a fixed score to not favor
+      // any of them, the others are favored by how recent they are
+      if (theCachePos < 3)
+        aScore = 0.75f;
+      else
+        aScore = std::pow (1.f - static_cast <float> (theCachePos - 3) / (THE_LRU_SIZE - 3), 1.5f);
+    }
+
+    // Boost vertices with few triangles left to get rid of them quickly
+    return aScore + 2.f / std::sqrt (static_cast <float> (theNbRemaining));
+  }
+}
+
+//=======================================================================
+//function : ACMR
+//purpose  : Compute ACMR of a triangle list for a FIFO cache
+//=======================================================================
+Standard_Real JtDecode_VertexCache::ACMR (const int32_t*      theIndices,
+                                          const Standard_Size theNbIndices,
+                                          const Standard_Size theNbVertices,
+                                          const Standard_Size theCacheSize)
+{
+  const Standard_Size aNbTriangles = theNbIndices / 3;
+  if (aNbTriangles == 0)
+    return 0.;
+
+  // A vertex is in the cache if less than theCacheSize misses happened
+  // since the miss that has put it there; zero stamp means never cached
+  std::vector<Standard_Size> aStamps (theNbVertices, 0);
+  Standard_Size aNbMisses = 0;
+  for (Standard_Size i = 0; i < aNbTriangles * 3; i++)
+  {
+    const int32_t aVertex = theIndices[i];
+    if (aVertex < 0 || static_cast <Standard_Size> (aVertex) >= theNbVertices)
+      continue;
+
+    Standard_Size& aStamp = aStamps[aVertex];
+    if (aStamp == 0 || aNbMisses - aStamp >= theCacheSize)
+      aStamp = ++aNbMisses;
+  }
+
+  return static_cast <Standard_Real> (aNbMisses) / aNbTriangles;
+}
+
+//=======================================================================
+//function : OptimizeTriangles
+//purpose  : Reorder triangles for vertex cache efficiency
+//=======================================================================
+Standard_Boolean JtDecode_VertexCache::OptimizeTriangles (const int32_t*      theIndices,
+                                                          const Standard_Size theNbIndices,
+                                                          const Standard_Size theNbVertices,
+                                                          int32_t*            theResult)
+{
+  const int32_t aNbTriangles = static_cast <int32_t> (theNbIndices / 3);
+  const int32_t aNbVertices  = static_cast <int32_t> (theNbVertices);
+
+  // Count triangles of each vertex
+  std::vector<int32_t> aTriStarts (aNbVertices + 1, 0);
+  for (int32_t i = 0; i < aNbTriangles * 3; i++)
+  {
+    const int32_t aVertex = theIndices[i];
+    if (aVertex < 0 || aVertex >= aNbVertices)
+      return Standard_False;
+    aTriStarts[aVertex + 1]++;
+  }
+
+  // Build lists of triangles of each vertex; the triangles not emitted yet
+  // are kept in the first aNbRemaining[v] entries of the vertex list
+  std::vector<int32_t> aNbRemaining (aNbVertices);
+  for (int32_t v = 0; v < aNbVertices; v++)
+  {
+    aNbRemaining[v]     = aTriStarts[v + 1];
+    aTriStarts  [v + 1] += aTriStarts[v];
+  }
+
+  std::vector<int32_t> aVertexTris (aTriStarts[aNbVertices]);
+  {
+    std::vector<int32_t> aFill (aTriStarts.begin(), aTriStarts.end() - 1);
+    for (int32_t i = 0; i < aNbTriangles * 3; i++)
+      aVertexTris[aFill[theIndices[i]]++] = i / 3;
+  }
+
+  // Initial scores
+  std::vector<int32_t> aCachePos    (aNbVertices, -1);
+  std::vector<float>   aVertexScore (aNbVertices);
+  for (int32_t v = 0; v < aNbVertices; v++)
+    aVertexScore[v] = vertexScore (-1, aNbRemaining[v]);
+
+  std::vector<float> aTriScore (aNbTriangles);
+  std::vector<bool>  anIsEmitted (aNbTriangles, false);
+  int32_t aBestTri = -1;
+  float   aBestScore = -1.f;
+  for (int32_t t = 0; t < aNbTriangles; t++)
+  {
+    const int32_t* aTri = theIndices + t * 3;
+    aTriScore[t] = aVertexScore[aTri[0]] + aVertexScore[aTri[1]] + aVertexScore[aTri[2]];
+    if (aTriScore[t] > aBestScore)
+    {
+      aBestScore = aTriScore[t];
+      aBestTri   = t;
+    }
+  }
+
+  // Emit the triangles one by one picking the best scored triangle
+  // of the cached vertices each time
+  std::vector<int32_t> aCache, aNewCache;
+  aCache   .reserve (THE_LRU_SIZE + 3);
+  aNewCache.reserve (THE_LRU_SIZE + 3);
+  int32_t aCursor = 0;
+  for (int32_t anOut = 0; anOut < aNbTriangles; anOut++)
+  {
+    // No cached vertex has triangles left, take the next triangle in the source order
+    if (aBestTri < 0)
+    {
+      while (anIsEmitted[aCursor])
+        aCursor++;
+      aBestTri = aCursor;
+    }
+
+    const int32_t* aTri = theIndices + aBestTri * 3;
+    theResult[anOut * 3 + 0] = aTri[0];
+    theResult[anOut * 3 + 1] = aTri[1];
+    theResult[anOut * 3 + 2] = aTri[2];
+    anIsEmitted[aBestTri] = true;
+
+    // Remove the triangle from the lists of its vertices
+    // and put the vertices in front of the cache
+    aNewCache.clear();
+    for (int k = 0; k < 3; k++)
+    {
+      const int32_t aVertex = aTri[k];
+      int32_t* aList = &aVertexTris[aTriStarts[aVertex]];
+      for (int32_t j = 0; j < aNbRemaining[aVertex]; j++)
+      {
+        if (aList[j] == aBestTri)
+        {
+          aList[j] = aList[--aNbRemaining[aVertex]];
+          break;
+        }
+      }
+
+      if (aCachePos[aVertex] != -2)
+      {
+        aNewCache.push_back (aVertex);
+        aCachePos[aVertex] = -2; // mark as already placed
+      }
+    }
+    for (size_t j = 0; j < aCache.size(); j++)
+    {
+      if (aCachePos[aCache[j]] != -2)
+      {
+        aNewCache.push_back (aCache[j]);
+        aCachePos[aCache[j]] = -2;
+      }
+    }
+
+    // Update positions and scores of the cached vertices; vertices
+    // pushed out of the cache get the score of non-cached ones
+    for (size_t j = 0; j < aNewCache.size(); j++)
+    {
+      const int32_t aVertex = aNewCache[j];
+      aCachePos   [aVertex] = static_cast <int32_t> (j) < THE_LRU_SIZE ? static_cast <int32_t> (j) : -1;
+      aVertexScore[aVertex] = vertexScore (aCachePos[aVertex], aNbRemaining[aVertex]);
+    }
+
+    // Update scores of the affected triangles and find the best one
+    aBestTri   = -1;
+    aBestScore = -1.f;
+    for (size_t j = 0; j < aNewCache.size(); j++)
+    {
+      const int32_t  aVertex = aNewCache[j];
+      const int32_t* aList   = &aVertexTris[aTriStarts[aVertex]];
+      for (int32_t l = 0; l < aNbRemaining[aVertex]; l++)
+      {
+        const int32_t  aT = aList[l];
+        const int32_t* aV = theIndices + aT * 3;
+        aTriScore[aT] = aVertexScore[aV[0]] + aVertexScore[aV[1]] + aVertexScore[aV[2]];
+        if (aTriScore[aT] > aBestScore)
+        {
+          aBestScore = aTriScore[aT];
+          aBestTri   = aT;
+        }
+      }
+    }
+
+    aNewCache.resize (Min (static_cast <int32_t> (aNewCache.size()), THE_LRU_SIZE));
+    aCache.swap (aNewCache);
+  }
+
+  return Standard_True;
+}
+
+//=======================================================================
+//function : OptimizeFetch
+//purpose  : Renumber vertices in order of their first use
+//=======================================================================
+Standard_Size JtDecode_VertexCache::OptimizeFetch (int32_t*            theIndices,
+                                                   const Standard_Size theNbIndices,
+                                                   const Standard_Size theNbVertices,
+                                                   int32_t*            theRemap)
+{
+  for (Standard_Size v = 0; v < theNbVertices; v++)
+    theRemap[v] = -1;
+
+  int32_t aNbUsed = 0;
+  for (Standard_Size i = 0; i < theNbIndices; i++)
+  {
+    int32_t& aNew = theRemap[theIndices[i]];
+    if (aNew < 0)
+      aNew = aNbUsed++;
+    theIndices[i] = aNew;
+  }
+
+  // Keep unreferenced vertices after the referenced ones
+  int32_t aNext = aNbUsed;
+  for (Standard_Size v = 0; v < theNbVertices; v++)
+  {
+    if (theRemap[v] < 0)
+      theRemap[v] = aNext++;
+  }
+
+  return static_cast <Standard_Size> (aNbUsed);
+}
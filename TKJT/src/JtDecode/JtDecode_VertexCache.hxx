@@ -0,0 +1,67 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+
+#ifndef _JtDecode_VertexCache_HeaderFile
+#define _JtDecode_VertexCache_HeaderFile
+
+#include <Standard.hxx>
+#include <JtData_Types.hxx>
+
+//! Post-transform vertex cache and vertex fetch optimization of triangle lists.
+//!
+//! Triangles are reordered with the linear-speed algorithm by T. Forsyth
+//! using a simulated LRU cache, then vertices are renumbered in order of
+//! their first use so that fetching them walks memory sequentially.
+//! Efficiency is measured by ACMR (average cache miss ratio): the number
+//! of vertex cache misses of a FIFO cache per triangle, from 0.5 at best
+//! for large regular meshes up to 3 for no reuse at all.
+class JtDecode_VertexCache
+{
+public:
+  //! Default size of the simulated vertex cache.
+  static const Standard_Size DefaultCacheSize = 32;
+
+public:
+  //! Compute ACMR of the given triangle list for a FIFO cache of the given size.
+  //! Indices out of range [0, theNbVertices) are ignored.
+  Standard_EXPORT static Standard_Real ACMR (const int32_t*      theIndices,
+                                             const Standard_Size theNbIndices,
+                                             const Standard_Size theNbVertices,
+                                             const Standard_Size theCacheSize = DefaultCacheSize);
+
+  //! Reorder triangles of the given list for vertex cache efficiency.
+  //! @param theIndices    - source triangle list
+  //! @param theNbIndices  - number of indices, should be a multiple of 3
+  //! @param theNbVertices - number of vertices the indices refer to
+  //! @param theResult     - output triangle list of theNbIndices indices
+  //! @return Standard_False if there is an index out of range; the output is not changed then.
+  Standard_EXPORT static Standard_Boolean OptimizeTriangles (const int32_t*      theIndices,
+                                                             const Standard_Size theNbIndices,
+                                                             const Standard_Size theNbVertices,
+                                                             int32_t*            theResult);
+
+  //! Renumber vertices in order of their first use in the triangle list
+  //! and update the indices in place. Unreferenced vertices go last.
+  //! @param theRemap - output array of theNbVertices new numbers of the vertices
+  //! @return number of referenced vertices.
+  Standard_EXPORT static Standard_Size OptimizeFetch (int32_t*            theIndices,
+                                                      const Standard_Size theNbIndices,
+                                                      const Standard_Size theNbVertices,
+                                                      int32_t*            theRemap);
+};
+
+#endif // _JtDecode_VertexCache_HeaderFile
@@ -124,6 +124,95 @@ JtDecode_VertexData::Handle JtDecode_VertexData::LoadCompressedNormals (JtData_R
   return aData;
 }
 
+JtDecode_VertexData::Handle JtDecode_VertexData::LoadCompressedColors (JtData_Reader& theReader)
+{
+  // Read parameters
+  Jt_I32 aColorsCount;
+  Jt_U8  aNbComponents;
+  Jt_U8  aNbBits;
+  if (!theReader.ReadI32 (aColorsCount)
+   || !theReader.ReadU8  (aNbComponents)
+   || !theReader.ReadU8  (aNbBits)
+   || aNbComponents == 0
+   || aNbComponents > JtDecode_VertexData_Quantized::MaxComponents)
+    return (Handle)0;
+
+  // Create decoder object
+  Handle aData;
+  if (aNbBits)
+  {
+    // HSV flag followed by quantizers of the hue/red, saturation/green,
+    // value/blue and alpha components
+    Jt_U8 anIsHSV;
+    JtDecode_VertexData_Quantized::UniformQuantizerData aQuantizerData[4];
+    if (!theReader.ReadU8 (anIsHSV)
+     || !aQuantizerData[0].Read (theReader)
+     || !aQuantizerData[1].Read (theReader)
+     || !aQuantizerData[2].Read (theReader)
+     || !aQuantizerData[3].Read (theReader))
+      return (Handle)0;
+
+    aData = new JtDecode_VertexData_Quantized (aQuantizerData, aNbComponents, JtDecode_Unpack_Lag1, anIsHSV != 0);
+  }
+  else
+    aData = new JtDecode_VertexData_ExpMant (aNbComponents, JtDecode_Unpack_Lag1);
+
+  // Load encoded data
+  if (!aData->load (theReader, &JtDecode_Int32CDP::Load2, aColorsCount))
+    return (Handle)0;
+
+  // Read hash value
+  Jt_I32 aHash;
+  if (!theReader.ReadI32 (aHash))
+    return (Handle)0;
+
+  // Success
+  return aData;
+}
+
+JtDecode_VertexData::Handle JtDecode_VertexData::LoadCompressedTexCoords (JtData_Reader& theReader)
+{
+  // Read parameters
+  Jt_I32 aTexCoordsCount;
+  Jt_U8  aNbComponents;
+  Jt_U8  aNbBits;
+  if (!theReader.ReadI32 (aTexCoordsCount)
+   || !theReader.ReadU8  (aNbComponents)
+   || !theReader.ReadU8  (aNbBits)
+   || aNbComponents == 0
+   || aNbComponents > JtDecode_VertexData_Quantized::MaxComponents)
+    return (Handle)0;
+
+  // Create decoder object
+  Handle aData;
+  if (aNbBits)
+  {
+    // a quantizer per component
+    JtDecode_VertexData_Quantized::UniformQuantizerData aQuantizerData[4];
+    for (Jt_U8 j = 0; j < aNbComponents; j++)
+    {
+      if (!aQuantizerData[j].Read (theReader))
+        return (Handle)0;
+    }
+
+    aData = new JtDecode_VertexData_Quantized (aQuantizerData, aNbComponents, JtDecode_Unpack_Lag1);
+  }
+  else
+    aData = new JtDecode_VertexData_ExpMant (aNbComponents, JtDecode_Unpack_Lag1);
+
+  // Load encoded data
+  if (!aData->load (theReader, &JtDecode_Int32CDP::Load2, aTexCoordsCount))
+    return (Handle)0;
+
+  // Read hash value
+  Jt_I32 aHash;
+  if (!theReader.ReadI32 (aHash))
+    return (Handle)0;
+
+  // Success
+  return aData;
+}
+
 Standard_Boolean JtDecode_VertexData::load (JtData_Reader&               theReader,
                                             JtDecode_Int32CDP::LoadFnPtr theLoader,
                                             const Jt_I32                 theVertexCount)
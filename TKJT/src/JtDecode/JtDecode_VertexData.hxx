@@ -44,6 +44,12 @@ public:
   //! Load lossless compressed vertex normals data.
   Standard_EXPORT static Handle LoadCompressedNormals (JtData_Reader& theReader);
 
+  //! Load compressed vertex colors data.
+  Standard_EXPORT static Handle LoadCompressedColors (JtData_Reader& theReader);
+
+  //! Load compressed vertex texture coordinates data.
+  Standard_EXPORT static Handle LoadCompressedTexCoords (JtData_Reader& theReader);
+
   //! Get expected count of output vertices.
   int32_t GetOutVertexCount() { return myPackages.IsEmpty() ? 0 : myPackages[0].GetOutValCount(); }
 
@@ -51,14 +57,26 @@ public:
   Standard_Integer GetOutCompCount() { return getOutCompCount (myPackages.Count()); }
 
   //! Decode the loaded data. Can be called only once for an instance.
+  //! The results are allocated on the heap even if an arena is current.
   Decoded::Mover Decode()
   {
-    Decoded aResults (GetOutVertexCount(), GetOutCompCount());
-    decode (aResults);
-    myPackages.Free();
+    Decoded aResults;
+    {
+      JtData_Arena::Scope aHeapScope (0L);
+      aResults.Allocate (GetOutVertexCount(), GetOutCompCount());
+    }
+    Decode (aResults);
     return aResults.Move();
   }
 
+  //! Decode the loaded data to the given buffer of GetOutVertexCount() values
+  //! of GetOutCompCount() components. Can be called only once for an instance.
+  void Decode (Decoded::Ref theResults)
+  {
+    decode (theResults);
+    myPackages.Free();
+  }
+
   //! D-tor
   virtual ~JtDecode_VertexData() {};
 
@@ -84,6 +102,18 @@ protected:
     return myPackages[thePackageNum].GetDecodingFunctor (theResult, *myUnpacker);
   }
 
+  //! Create a decoding functor for package with the given index using the given unpacker
+  //! instead of the one specified on construction.
+  JtDecode_Int32CDP::DecodingFunctor getDecodingFunctor (const Standard_Size thePackageNum,
+                                                               Jt_VecU32&    theResult,
+                                                               JtDecode_Unpack& theUnpacker)
+  {
+    return myPackages[thePackageNum].GetDecodingFunctor (theResult, theUnpacker);
+  }
+
+  //! Return the unpacker specified on construction.
+  JtDecode_Unpack& unpacker() const { return *myUnpacker; }
+
   //! Get expected count of output components; to be reimplemented in derived classes.
   Standard_EXPORT virtual Standard_Integer getOutCompCount (Standard_Size thePackageCount) = 0;
 
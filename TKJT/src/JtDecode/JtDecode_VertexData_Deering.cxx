@@ -24,13 +24,16 @@ namespace
 {
   static const Standard_Integer TABLE_BITS = 13;
 
+  //! Number of normals decoded per block.
+  static const Standard_Integer BLOCK_SIZE = 16;
+
   struct SinCos
   {
-    Standard_Real Sin, Cos;
+    Jt_F32 Sin, Cos;
     void Set (Standard_Real aValue)
     {
-      Sin = sin (aValue);
-      Cos = cos (aValue);
+      Sin = static_cast <Jt_F32> (sin (aValue));
+      Cos = static_cast <Jt_F32> (cos (aValue));
     }
   };
 
@@ -86,75 +89,66 @@ void JtDecode_VertexData_Deering::decode (Decoded::Ref theResults)
   aDecodeTasks.Run (getDecodingFunctor (3, aPsiCodes));
   aDecodeTasks.Wait();
 
-  Standard_Integer anOffset = TABLE_BITS - myNbBits;
-  for (Decoded::SizeType i = 0; i < theResults.Count(); ++i)
-  {
-    Jt_U32 aSextant = aSextantCodes[i];
+  const Standard_Integer  anOffset = TABLE_BITS - myNbBits;
+  const Decoded::SizeType aCount   = theResults.Count();
 
-    const SinCos& aThetaPar = LOOKUP_TABLE.Theta[(aThetaCodes[i] + (aSextant & 1)) << anOffset];
-    const SinCos& aPsiPar   = LOOKUP_TABLE.Psi  [ aPsiCodes  [i]                   << anOffset];
+  // Decode the normals by blocks: first fetch the angles from the lookup table,
+  // then compute the components without branches to let the compiler vectorize the loop
+  for (Decoded::SizeType aStart = 0; aStart < aCount; aStart += BLOCK_SIZE)
+  {
+    const Standard_Integer aBlockSize = aCount - aStart < BLOCK_SIZE
+      ? static_cast <Standard_Integer> (aCount - aStart) : BLOCK_SIZE;
 
-    Jt_F32 x = static_cast <Jt_F32> (aPsiPar.Cos * aThetaPar.Cos);
-    Jt_F32 y = static_cast <Jt_F32> (aPsiPar.Sin);
-    Jt_F32 z = static_cast <Jt_F32> (aPsiPar.Cos * aThetaPar.Sin);
+    Jt_F32 aPsiCos[BLOCK_SIZE], aPsiSin[BLOCK_SIZE], aThetaCos[BLOCK_SIZE], aThetaSin[BLOCK_SIZE];
+    Jt_U32 aSextants[BLOCK_SIZE], anOctants[BLOCK_SIZE];
 
-    // Change coordinates based on the sextant
-    Jt_DirF32 aResult;
-    switch (aSextant)
+    for (Standard_Integer k = 0; k < aBlockSize; ++k)
     {
-    default:
-    case 0: // No op
-      aResult.X = x;
-      aResult.Y = y;
-      aResult.Z = z;
-      break;
-
-    case 1: // Mirror about x=z plane
-      aResult.X = z;
-      aResult.Y = y;
-      aResult.Z = x;
-      break;
-
-    case 2: // Rotate CW
-      aResult.X = y;
-      aResult.Y = z;
-      aResult.Z = x;
-      break;
-
-    case 3: // Mirror about x=y plane
-      aResult.X = y;
-      aResult.Y = x;
-      aResult.Z = z;
-      break;
-
-    case 4: // Rotate CCW
-      aResult.X = z;
-      aResult.Y = x;
-      aResult.Z = y;
-      break;
-
-    case 5: // Mirror about y=z plane
-      aResult.X = x;
-      aResult.Y = z;
-      aResult.Z = y;
-      break;
+      const Decoded::SizeType i = aStart + k;
+      const Jt_U32 aSextant = aSextantCodes[i];
+
+      const SinCos& aThetaPar = LOOKUP_TABLE.Theta[(aThetaCodes[i] + (aSextant & 1)) << anOffset];
+      const SinCos& aPsiPar   = LOOKUP_TABLE.Psi  [ aPsiCodes  [i]                   << anOffset];
+
+      aThetaCos[k] = aThetaPar.Cos;
+      aThetaSin[k] = aThetaPar.Sin;
+      aPsiCos  [k] = aPsiPar.Cos;
+      aPsiSin  [k] = aPsiPar.Sin;
+      aSextants[k] = aSextant > 5 ? 0 : aSextant;
+      anOctants[k] = anOctantCodes[i];
     }
 
-    // Change some more based on the octant
-    Jt_U32 anOctant = anOctantCodes[i];
-
-    // if first bit is 0, negate x component
-    if ((anOctant & 4) == 0)
-      aResult.X = -aResult.X;
-
-    // if second bit is 0, negate y component
-    if ((anOctant & 2) == 0)
-      aResult.Y = -aResult.Y;
-
-    // if third bit is 0, negate z component
-    if ((anOctant & 1) == 0)
-      aResult.Z = -aResult.Z;
+    Jt_F32 aResX[BLOCK_SIZE], aResY[BLOCK_SIZE], aResZ[BLOCK_SIZE];
+    for (Standard_Integer k = 0; k < aBlockSize; ++k)
+    {
+      const Jt_F32 x = aPsiCos[k] * aThetaCos[k];
+      const Jt_F32 y = aPsiSin[k];
+      const Jt_F32 z = aPsiCos[k] * aThetaSin[k];
+
+      // Change coordinates based on the sextant:
+      // 0 - no op,             1 - mirror about x=z plane,
+      // 2 - rotate CW,         3 - mirror about x=y plane,
+      // 4 - rotate CCW,        5 - mirror about y=z plane
+      const Jt_U32 aSextant = aSextants[k];
+      const Jt_F32 aX = (aSextant == 0 || aSextant == 5) ? x : (aSextant == 1 || aSextant == 4) ? z : y;
+      const Jt_F32 aY = (aSextant == 0 || aSextant == 1) ? y : (aSextant == 3 || aSextant == 4) ? x : z;
+      const Jt_F32 aZ = (aSextant == 0 || aSextant == 3) ? z : (aSextant == 1 || aSextant == 2) ? x : y;
+
+      // Change some more based on the octant:
+      // if the first, second or third bit is 0, negate x, y or z component correspondingly
+      const Jt_U32 anOctant = anOctants[k];
+      aResX[k] = aX * static_cast <Jt_F32> (static_cast <Standard_Integer> ((anOctant >> 1) & 2) - 1);
+      aResY[k] = aY * static_cast <Jt_F32> (static_cast <Standard_Integer> ( anOctant       & 2) - 1);
+      aResZ[k] = aZ * static_cast <Jt_F32> (static_cast <Standard_Integer> ((anOctant << 1) & 2) - 1);
+    }
 
-    theResults[i] = aResult;
+    for (Standard_Integer k = 0; k < aBlockSize; ++k)
+    {
+      Jt_DirF32 aResult;
+      aResult.X = aResX[k];
+      aResult.Y = aResY[k];
+      aResult.Z = aResZ[k];
+      theResults[aStart + k] = aResult;
+    }
   }
 }
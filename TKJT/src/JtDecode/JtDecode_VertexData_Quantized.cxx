@@ -15,7 +15,68 @@
 // on <http://www.gnu.org/licenses/>.
 
 #include <JtDecode_VertexData_Quantized.hxx>
-#include <JtData_VectorRef.hxx>
+
+#include <cmath>
+
+//#define NO_JT_MULTITHREADING
+#include <JtData_Parallel.hxx>
+
+namespace
+{
+  //! Dequantize the given codes writing the values to the output with the given stride.
+  //! If requested, the codes are unpacked by Lag1 predictor on the fly.
+  //! The values are computed in double precision and rounded to float once:
+  //! with single precision arithmetic the product and the sum are rounded separately,
+  //! so values near zero (where the minimum and the product cancel) could be off
+  //! by many float ulps, up to a fraction of the quantization step.
+  void dequantize (const Jt_VecU32& theCodes,
+                   const Standard_Boolean theToUnpack,
+                   const JtDecode_VertexData_Quantized::UniformQuantizerData& theQuantizerData,
+                   Jt_F32* theOutput,
+                   const Standard_Integer theStride)
+  {
+    Standard_Real aMaxCode = theQuantizerData.bits < 32 ? (1 << theQuantizerData.bits) : 0xFFFFFFFF;
+
+    const Standard_Real aMin              = theQuantizerData.min;
+    const Standard_Real aDecodeMultiplier = (theQuantizerData.max - theQuantizerData.min) / aMaxCode;
+
+    const Jt_U32* aCodes = theCodes.Data();
+    const Jt_I32  aCount = theCodes.Count();
+    Jt_F32*       anOut  = theOutput;
+
+    // the first four codes are not predicted
+    Jt_U32 aCode = 0;
+    for (Jt_I32 i = 0; i < aCount; i++, anOut += theStride)
+    {
+      aCode = theToUnpack && i >= 4 ? aCode + aCodes[i] : aCodes[i];
+      *anOut = static_cast <Jt_F32> (aMin + (static_cast <Standard_Real> (aCode) - 0.5) * aDecodeMultiplier);
+    }
+  }
+
+  //! Convert a color from HSV (all components in [0, 1]) to RGB in place.
+  void hsvToRgb (Jt_F32* theColor)
+  {
+    const Jt_F32 aHue = (theColor[0] - static_cast <Jt_F32> (floor (theColor[0]))) * 6.0f;
+    const Jt_F32 aSat = theColor[1];
+    const Jt_F32 aVal = theColor[2];
+
+    const Standard_Integer aSector = Min (static_cast <Standard_Integer> (aHue), 5);
+    const Jt_F32 aFrac = aHue - static_cast <Jt_F32> (aSector);
+    const Jt_F32 aP = aVal * (1.0f - aSat);
+    const Jt_F32 aQ = aVal * (1.0f - aSat * aFrac);
+    const Jt_F32 aT = aVal * (1.0f - aSat * (1.0f - aFrac));
+
+    switch (aSector)
+    {
+      case 0:  theColor[0] = aVal; theColor[1] = aT;   theColor[2] = aP;   break;
+      case 1:  theColor[0] = aQ;   theColor[1] = aVal; theColor[2] = aP;   break;
+      case 2:  theColor[0] = aP;   theColor[1] = aVal; theColor[2] = aT;   break;
+      case 3:  theColor[0] = aP;   theColor[1] = aQ;   theColor[2] = aVal; break;
+      case 4:  theColor[0] = aT;   theColor[1] = aP;   theColor[2] = aVal; break;
+      default: theColor[0] = aVal; theColor[1] = aP;   theColor[2] = aQ;   break;
+    }
+  }
+}
 
 Standard_Boolean JtDecode_VertexData_Quantized::UniformQuantizerData::Read (JtData_Reader& theReader)
 {
@@ -32,7 +93,25 @@ JtDecode_VertexData_Quantized::JtDecode_VertexData_Quantized (
                               const Standard_Size       theNbComponents,
                                     JtDecode_Unpack&    theUnpacker)
   : JtDecode_VertexData (theNbComponents, theUnpacker)
-  , myQuantizerData     (theQuantizerData) {}
+  , myIsHSV             (Standard_False)
+{
+  myQuantizerData[0] = theQuantizerData.X;
+  myQuantizerData[1] = theQuantizerData.Y;
+  myQuantizerData[2] = theQuantizerData.Z;
+  myQuantizerData[3] = theQuantizerData.Z;
+}
+
+JtDecode_VertexData_Quantized::JtDecode_VertexData_Quantized (
+                              const UniformQuantizerData* theQuantizerData,
+                              const Standard_Size         theNbComponents,
+                                    JtDecode_Unpack&      theUnpacker,
+                              const Standard_Boolean      theIsHSV)
+  : JtDecode_VertexData (theNbComponents, theUnpacker)
+  , myIsHSV             (theIsHSV)
+{
+  for (Standard_Size j = 0; j < MaxComponents; j++)
+    myQuantizerData[j] = theQuantizerData[j < theNbComponents ? j : theNbComponents - 1];
+}
 
 Standard_Integer JtDecode_VertexData_Quantized::getOutCompCount (Standard_Size thePackageCount)
 {
@@ -41,24 +120,30 @@ Standard_Integer JtDecode_VertexData_Quantized::getOutCompCount (Standard_Size t
 
 void JtDecode_VertexData_Quantized::decode (Decoded::Ref theResults)
 {
-  for (Decoded::CompCountType j = 0; j < theResults.CompCount(); j++)
-  {
-    Jt_VecI32 aCodes (decodePackage (j));
+  // Decode all the components in parallel; Lag1 unpacking is done below
+  // along with dequantization to avoid an extra pass over the codes
+  const Decoded::CompCountType aCompCount = theResults.CompCount();
+  const Standard_Boolean       isLag1     = &unpacker() == &JtDecode_Unpack_Lag1;
 
-    const UniformQuantizerData& aCurQuantizerData =
-      JtData_VectorRef<const UniformQuantizerData> (myQuantizerData)[j];
-
-    Standard_Real    aMin  = aCurQuantizerData.min;
-    Standard_Real    aMax  = aCurQuantizerData.max;
-    Standard_Integer aBits = aCurQuantizerData.bits;
+  Jt_VecU32 aCodes[MaxComponents];
+  {
+    JtData_Parallel::TaskGroup aDecodeTasks;
+    for (Decoded::CompCountType j = 0; j < aCompCount && j < (Decoded::CompCountType) MaxComponents; j++)
+    {
+      if (isLag1)
+        aDecodeTasks.Run (getDecodingFunctor (j, aCodes[j], JtDecode_Unpack_Null));
+      else
+        aDecodeTasks.Run (getDecodingFunctor (j, aCodes[j]));
+    }
+    aDecodeTasks.Wait();
+  }
 
-    Standard_Real aMaxCode = aBits < 32 ? (1 << aBits) : 0xFFFFFFFF;
-    Standard_Real aDecodeMultiplier = (aMax - aMin) / aMaxCode;
+  for (Decoded::CompCountType j = 0; j < aCompCount && j < (Decoded::CompCountType) MaxComponents; j++)
+    dequantize (aCodes[j], isLag1, myQuantizerData[j], theResults.Data() + j, aCompCount);
 
+  if (myIsHSV && aCompCount >= 3)
+  {
     for (Decoded::SizeType i = 0; i < theResults.Count(); i++)
-    {
-      Standard_Real aValue = aMin + (static_cast<Jt_U32>(aCodes[i]) - 0.5) * aDecodeMultiplier;
-      theResults[i][j] = static_cast <float> (aValue);
-    }
+      hsvToRgb (theResults.Data() + i * aCompCount);
   }
 }
@@ -41,12 +41,23 @@ public:
     Standard_Boolean Read (JtData_Reader& theReader);
   };
 
+  //! Maximum number of components.
+  static const Standard_Size MaxComponents = 4;
+
   //! Constructor.
   Standard_EXPORT JtDecode_VertexData_Quantized (
     const PointQuantizerData& theQuantizerData,
     const Standard_Size theNbComponents,
     JtDecode_Unpack& theUnpacker = JtDecode_Unpack_Null);
 
+  //! Constructor with a quantizer per component (up to MaxComponents);
+  //! theIsHSV requests conversion of HSV colors to RGB.
+  Standard_EXPORT JtDecode_VertexData_Quantized (
+    const UniformQuantizerData* theQuantizerData,
+    const Standard_Size theNbComponents,
+    JtDecode_Unpack& theUnpacker = JtDecode_Unpack_Null,
+    const Standard_Boolean theIsHSV = Standard_False);
+
 protected:
   //! Get expected count of output components.
   Standard_EXPORT virtual Standard_Integer getOutCompCount (Standard_Size thePackageCount);
@@ -54,7 +65,8 @@ protected:
   //! Decoding method.
   Standard_EXPORT virtual void decode (Decoded::Ref theResults);
 
-  PointQuantizerData myQuantizerData;
+  UniformQuantizerData myQuantizerData[MaxComponents];
+  Standard_Boolean     myIsHSV;
 };
 
 #endif
@@ -0,0 +1,60 @@
+// JT format reading and visualization tools
+// Copyright (C) 2013-2015 OPEN CASCADE SAS
+// 
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// Copy of the GNU General Public License is in LICENSE.txt and  
+// on <http://www.gnu.org/licenses/>.
+
+#ifndef _JtElement_ShapeLOD_Sink_HeaderFile
+#define _JtElement_ShapeLOD_Sink_HeaderFile
+
+#include <JtElement_ShapeLOD_Vertex.hxx>
+
+//! Receiver of decoded mesh data.
+//!
+//! A sink given to JtData_Model::LoadSegments() or ReadSegment() provides
+//! the buffers for the mesh of each vertex shape LOD read from the segments,
+//! so that the decoders write the final indices and vertex parameters straight
+//! to the consumer's storage and the element keeps no copy of them. The buffers
+//! are requested while the element is read, before the data is decoded; each
+//! of them at most once per reading, and only for the parameters present.
+//! The sink is set to the elements by the model reading the segment,
+//! whatever thread reads it, so calls for different LODs can be concurrent.
+class JtElement_ShapeLOD_Sink
+{
+public:
+  typedef JtElement_ShapeLOD_Vertex::Parameter Parameter;
+
+public:
+  //! Destructor.
+  virtual ~JtElement_ShapeLOD_Sink() {}
+
+  //! Provide the buffer for the given number of triangle vertex indices of the LOD.
+  //! Returning null fails the reading of the LOD.
+  virtual int32_t* IndicesBuffer (const JtElement_ShapeLOD_Vertex& theLOD,
+                                  const int32_t                    theCount) = 0;
+
+  //! Provide the buffer for the given number of values of the vertex parameter
+  //! of the LOD, each of the given number of float components.
+  //! Returning null fails the reading of the LOD.
+  virtual float* ParameterBuffer (const JtElement_ShapeLOD_Vertex& theLOD,
+                                  const Parameter                  theParameter,
+                                  const int32_t                    theCount,
+                                  const int32_t                    theCompCount) = 0;
+
+  //! Finish the reading of the LOD: the provided buffers are filled if it is done,
+  //! otherwise their contents is undefined. Not called if no buffer was provided.
+  virtual void Finish (const JtElement_ShapeLOD_Vertex& theLOD,
+                       const Standard_Boolean           theIsDone) = 0;
+};
+
+#endif // _JtElement_ShapeLOD_Sink_HeaderFile
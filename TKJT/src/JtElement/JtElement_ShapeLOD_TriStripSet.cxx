@@ -30,14 +30,12 @@ IMPLEMENT_OBJECT_CLASS(JtElement_ShapeLOD_TriStripSet, "Tri-Strip Set Shape LOD
 Standard_Boolean JtElement_ShapeLOD_TriStripSet::Read (JtData_Reader& theReader)
 {
   Jt_I16 aVersion;
-  if (!readVertexShapeLODData (theReader, Standard_True)
-   || !theReader.ReadI16 (aVersion))
-    return Standard_False;
-
-  if (theReader.Model()->MajorVersion() < 9)
-    return readVertexBasedShapeCompressedRepData (theReader);
-  else
-    return Standard_True;
+  const Standard_Boolean isRead = readVertexShapeLODData (theReader, Standard_True)
+                               && theReader.ReadI16 (aVersion)
+                               && (theReader.Model()->MajorVersion() > 8
+                                || readVertexBasedShapeCompressedRepData (theReader));
+  finishSink (isRead);
+  return isRead;
 }
 
 //=======================================================================
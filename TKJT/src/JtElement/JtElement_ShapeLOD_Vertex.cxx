@@ -15,17 +15,22 @@
 // on <http://www.gnu.org/licenses/>.
 
 #include <JtElement_ShapeLOD_Vertex.hxx>
+#include <JtElement_ShapeLOD_Sink.hxx>
 
 #include <NCollection_Handle.hxx>
 
 #include <JtData_Reader.hxx>
 #include <JtData_Inflate.hxx>
+#include <JtData_Arena.hxx>
+#include <JtData_Message.hxx>
 
 #include <JtDecode_Int32CDP.hxx>
 #include <JtDecode_VertexData.hxx>
 #include <JtDecode_MeshCoderDriver.hxx>
+#include <JtDecode_Int32CDPScheduler.hxx>
+#include <JtDecode_VertexCache.hxx>
 
-#include <map>
+#include <cstring>
 #include <vector>
 
 //#define NO_JT_MULTITHREADING
@@ -41,15 +46,22 @@ class JtElement_ShapeLOD_Vertex::VertexDataDecodeTask
 {
 public:
 
-  VertexDataDecodeTask (JtData_SingleHandle<JtDecode_VertexData> theData, VertexData& theResult)
-    : myData (theData) , myResultPtr (&theResult) {}
+  VertexDataDecodeTask (JtData_SingleHandle<JtDecode_VertexData> theData,
+                        const VertexData::Ref& theResult,
+                        JtData_Arena&          theArena)
+    : myData (theData) , myResult (theResult), myArena (&theArena) {}
 
-  void operator ()() const { *myResultPtr = const_cast <JtDecode_VertexData&> (*myData).Decode(); }
+  void operator ()() const
+  {
+    JtData_Arena::Scope anArenaScope (myArena);
+    const_cast <JtDecode_VertexData&> (*myData).Decode (myResult);
+  }
 
 private:
 
   NCollection_Handle<JtDecode_VertexData> myData;
-  VertexData* myResultPtr;
+  VertexData::Ref myResult;
+  JtData_Arena* myArena;
 };
 
 class JtElement_ShapeLOD_Vertex::MeshDecodeTask
@@ -57,23 +69,201 @@ class JtElement_ShapeLOD_Vertex::MeshDecodeTask
   NCollection_Handle<JtDecode_MeshCoderDriver::InputData> myData;
   IndicesVec* myVertexIndicesPtr;
   IndicesVec* myNormalIndicesPtr;
+  JtData_Arena* myArena;
 
 public:
   MeshDecodeTask (JtData_SingleHandle<JtDecode_MeshCoderDriver::InputData> theData,
-                  IndicesVec& theVertexIndices,
-                  IndicesVec& theNormalIndices)
+                  IndicesVec&   theVertexIndices,
+                  IndicesVec&   theNormalIndices,
+                  JtData_Arena& theArena)
     : myData             (theData)
     , myVertexIndicesPtr (&theVertexIndices)
-    , myNormalIndicesPtr (&theNormalIndices) {}
+    , myNormalIndicesPtr (&theNormalIndices)
+    , myArena            (&theArena) {}
 
   void operator ()() const
   {
+    // Symbol streams of the driver are allocated from the arena,
+    // the output indices are not
+    JtData_Arena::Scope anArenaScope (myArena);
     JtDecode_MeshCoderDriver aMeshCoderDriver;
     aMeshCoderDriver.SetInputData (const_cast <JtDecode_MeshCoderDriver::InputData&> (*myData));
     aMeshCoderDriver.Decode       (myVertexIndicesPtr, myNormalIndicesPtr);
   }
 };
 
+//! Open addressing hash map of (coord index, normal index) pairs
+//! to indices of unique pairs.
+class JtElement_ShapeLOD_Vertex::IndexPairMap
+{
+public:
+  //! Create a map for about the given number of pairs.
+  IndexPairMap (const int32_t theExpectedCount) : myCount (0)
+  {
+    Standard_Size aCapacity = 16;
+    while (aCapacity < static_cast<Standard_Size> (theExpectedCount) * 2)
+      aCapacity *= 2;
+    rehash (aCapacity);
+  }
+
+  //! Return index of the given pair if it is in the map,
+  //! otherwise add the pair with the given new index and return the new index.
+  int32_t FindOrAdd (const int32_t theVertexIdx, const int32_t theNormalIdx, const int32_t theNewIndex)
+  {
+    const uint64_t aKey = (static_cast<uint64_t> (static_cast<uint32_t> (theVertexIdx)) << 32)
+                        | static_cast<uint32_t> (theNormalIdx);
+
+    for (Standard_Size i = slot (aKey); ; i = (i + 1) & myMask)
+    {
+      Entry& anEntry = myEntries[i];
+      if (anEntry.Index < 0)
+      {
+        anEntry.Key   = aKey;
+        anEntry.Index = theNewIndex;
+
+        // keep the load factor at most 1/2
+        if (++myCount * 2 > myEntries.size())
+          rehash (myEntries.size() * 2);
+
+        return theNewIndex;
+      }
+
+      if (anEntry.Key == aKey)
+        return anEntry.Index;
+    }
+  }
+
+private:
+  struct Entry
+  {
+    uint64_t Key;
+    int32_t  Index; //!< index of the pair or -1 for an empty entry
+  };
+
+  //! Return the starting slot for the key.
+  Standard_Size slot (const uint64_t theKey) const
+  {
+    return static_cast<Standard_Size> ((theKey * 0x9E3779B97F4A7C15ULL) >> 32) & myMask;
+  }
+
+  //! Reallocate the entries with the given capacity (a power of two).
+  void rehash (const Standard_Size theCapacity)
+  {
+    Entry anEmpty = {0, -1};
+    std::vector<Entry> anOldEntries (theCapacity, anEmpty);
+    anOldEntries.swap (myEntries);
+    myMask = theCapacity - 1;
+
+    for (Standard_Size i = 0; i < anOldEntries.size(); i++)
+    {
+      const Entry& anEntry = anOldEntries[i];
+      if (anEntry.Index < 0)
+        continue;
+
+      Standard_Size j = slot (anEntry.Key);
+      while (myEntries[j].Index >= 0)
+        j = (j + 1) & myMask;
+      myEntries[j] = anEntry;
+    }
+  }
+
+private:
+  std::vector<Entry> myEntries;
+  Standard_Size      myMask;
+  Standard_Size      myCount;
+};
+
+//! Fills coords and attributes (normals, colors, texture coordinates)
+//! of unique pairs from the source vectors. Attributes with empty
+//! output vectors are skipped.
+class JtElement_ShapeLOD_Vertex::UniquePairsGatherTask
+{
+  static const Standard_Size NbAttributes = 3;
+
+  const VertexData*      myUniqueVertices;
+  const VertexData*      myUniqueAttributes[NbAttributes];
+  const int32_t*         myVertexIndices;
+  const int32_t*         myAttributeIndices;
+  const int32_t*         myIdxIndices;
+  const VertexData::Ref* myVertices;
+  const VertexData::Ref* myAttributes[NbAttributes];
+
+public:
+  UniquePairsGatherTask (const VertexData&      theUniqueVertices,
+                         const VertexData&      theUniqueNormals,
+                         const VertexData&      theUniqueColors,
+                         const VertexData&      theUniqueTexCoords,
+                         const IndicesVec&      theVertexIndices,
+                         const IndicesVec&      theAttributeIndices,
+                         const IndicesVec&      theIdxIndices,
+                         const VertexData::Ref& theVertices,
+                         const VertexData::Ref& theNormals,
+                         const VertexData::Ref& theColors,
+                         const VertexData::Ref& theTexCoords)
+    : myUniqueVertices   (&theUniqueVertices)
+    , myVertexIndices    (theVertexIndices.Data())
+    , myAttributeIndices (theAttributeIndices.Data())
+    , myIdxIndices       (theIdxIndices.Data())
+    , myVertices         (&theVertices)
+  {
+    myUniqueAttributes[0] = &theUniqueNormals;   myAttributes[0] = &theNormals;
+    myUniqueAttributes[1] = &theUniqueColors;    myAttributes[1] = &theColors;
+    myUniqueAttributes[2] = &theUniqueTexCoords; myAttributes[2] = &theTexCoords;
+  }
+
+  void operator ()(const int32_t theUniquePairIdx) const
+  {
+    int32_t anIdxIdx = myIdxIndices[theUniquePairIdx];
+    (*myVertices)[theUniquePairIdx] = (*myUniqueVertices)[myVertexIndices[anIdxIdx]];
+
+    for (Standard_Size k = 0; k < NbAttributes; k++)
+    {
+      if (!myAttributes[k]->IsEmpty())
+        (*myAttributes[k])[theUniquePairIdx] = (*myUniqueAttributes[k])[myAttributeIndices[anIdxIdx]];
+    }
+  }
+};
+
+//! Optimizes vertex cache efficiency of one of the given objects
+//! if it is a vertex shape LOD.
+class JtElement_ShapeLOD_Vertex::VertexCacheTask
+{
+  const JtData_Object::VectorOfObjects* myObjects;
+  CacheStatistics*                      myStats;
+
+public:
+  VertexCacheTask (const JtData_Object::VectorOfObjects& theObjects,
+                   std::vector<CacheStatistics>&         theStats)
+    : myObjects (&theObjects), myStats (&theStats[0]) {}
+
+  void operator ()(const Standard_Size theIdx) const
+  {
+    Handle(JtElement_ShapeLOD_Vertex) aLOD =
+      Handle(JtElement_ShapeLOD_Vertex)::DownCast ((*myObjects)[theIdx]);
+
+    // LODs left as is are not counted in the statistics
+    if (!aLOD.IsNull() && !aLOD->OptimizeVertexCache (myStats[theIdx]))
+      myStats[theIdx] = CacheStatistics();
+  }
+};
+
+namespace
+{
+  //! Move vertex parameters to their new positions; an empty vector is kept.
+  void remapVertexData (JtElement_ShapeLOD_Vertex::VertexData& theData,
+                        const std::vector<int32_t>&            theRemap)
+  {
+    if (theData.IsEmpty())
+      return;
+
+    JtElement_ShapeLOD_Vertex::VertexData aRemapped (theData.Count(), theData.CompCount());
+    for (int32_t i = 0; i < theData.Count(); i++)
+      aRemapped[theRemap[i]] = theData[i];
+
+    theData << aRemapped;
+  }
+}
+
 //=======================================================================
 //function : QuantizationParams::Read
 //purpose  :
@@ -204,13 +394,22 @@ Standard_Size JtElement_ShapeLOD_Vertex::VertexBinding2::NbTextCoordComponents
   }
 }
 
+//=======================================================================
+//function : JtElement_ShapeLOD_Vertex
+//purpose  : Default constructor
+//=======================================================================
+JtElement_ShapeLOD_Vertex::JtElement_ShapeLOD_Vertex()
+: mySink (0L), myIsPassedToSink (Standard_False) {}
+
 //=======================================================================
 //function : Read
 //purpose  : Read this entity from a translate file
 //=======================================================================
 Standard_Boolean JtElement_ShapeLOD_Vertex::Read (JtData_Reader& theReader)
 {
-  return readVertexShapeLODData (theReader);
+  const Standard_Boolean isRead = readVertexShapeLODData (theReader);
+  finishSink (isRead);
+  return isRead;
 }
 
 //=======================================================================
@@ -223,6 +422,31 @@ Standard_Integer JtElement_ShapeLOD_Vertex::Dump (Standard_OStream& theStream) c
   return JtElement_ShapeLOD_Base::Dump (theStream);
 }
 
+//=======================================================================
+//function : MemorySize
+//purpose  : Return size of the decoded vectors
+//=======================================================================
+Standard_Size JtElement_ShapeLOD_Vertex::MemorySize() const
+{
+  const VertexData* aParams[] = {&myVertices, &myNormals, &myColors, &myTexCoords};
+
+  Standard_Size aSize = sizeof (*this) + sizeof (int32_t) * static_cast<Standard_Size> (myIndices.Count());
+  for (Standard_Size k = 0; k < 4; k++)
+    aSize += sizeof (float) * static_cast<Standard_Size> (aParams[k]->Count())
+                            * static_cast<Standard_Size> (aParams[k]->CompCount());
+
+  return aSize;
+}
+
+//=======================================================================
+//function : IsCacheable
+//purpose  : Return false if the decoded data was written to buffers of a sink
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::IsCacheable() const
+{
+  return !myIsPassedToSink;
+}
+
 //=======================================================================
 //function : readVertexShapeLODData
 //purpose  : Read Vertex Shape LOD Data collection
@@ -234,6 +458,10 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexShapeLODData (
   myIndices.Free();
   myVertices.Free();
   myNormals.Free();
+  myColors.Free();
+  myTexCoords.Free();
+
+  myIsPassedToSink = Standard_False;
 
   if (theReader.Model()->MajorVersion() < 9)
   {
@@ -270,10 +498,13 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexShapeLODData (
     }
 
     if (theIsTriStripSet)
-      return readTopologicallyCompressedData (theReader);
-    else
-      // TODO: Read TopoMesh Compressed Rep Data
+      return readTopoMeshData (theReader, Standard_True);
+
+    // TopoMesh Compressed LOD Data; only version 1 of its rep data is supported
+    if (aVersion4 != 1)
       return Standard_True;
+
+    return readTopoMeshData (theReader, Standard_False);
   }
 }
 
@@ -307,12 +538,16 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
     return Standard_False;
   }
 
+  // Arena for temporary decoding buffers, released when the segment is read
+  JtData_Arena aDecodeArena;
+
   /* Primitive List Indices is a vector of indices into the uncompressed
    * Raw Vertex Data marking the start/beginning of primitives.
    * The Primitive List Indices array uses the Int32 version of the CODEC
    * to compress and encode data. */
   Jt_VecI32 aPimitiveListIndices;
   {
+    JtData_Arena::Scope anArenaScope (&aDecodeArena);
     JtDecode_Int32CDP anEncodedPimitiveListIndices;
     if (!anEncodedPimitiveListIndices.Load1 (theReader))
         return Standard_False;
@@ -338,6 +573,27 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
       return Standard_False;
     }
 
+    // determine number of vertices
+    VertexData::SizeType aVertexCount = aPimitiveListIndices.Last();
+
+    // allocate output storage; only per-vertex attributes are stored in the data
+    const Standard_Boolean hasNormals   = aNormalBinding    == VertexBinding1::PerVertex;
+    const Standard_Boolean hasColors    = aColorBinding     == VertexBinding1::PerVertex;
+    const Standard_Boolean hasTexCoords = aTextCoordBinding == VertexBinding1::PerVertex;
+    Jt_F32 *aVerticesData = 0L, *aNormalsData = 0L, *aColorsData = 0L, *aTexCoordsData = 0L;
+    if (!allocateParameter (Parameter_Vertices, aVertexCount, 3, aVerticesData)
+     || (hasNormals   && !allocateParameter (Parameter_Normals,   aVertexCount, 3, aNormalsData))
+     || (hasColors    && !allocateParameter (Parameter_Colors,    aVertexCount, 3, aColorsData))
+     || (hasTexCoords && !allocateParameter (Parameter_TexCoords, aVertexCount, 2, aTexCoordsData)))
+    {
+      return Standard_False;
+    }
+
+    VertexData::Ref aVertices  (aVerticesData,  aVerticesData  ? aVertexCount : 0, 3),
+                    aNormals   (aNormalsData,   aNormalsData   ? aVertexCount : 0, 3),
+                    aColors    (aColorsData,    aColorsData    ? aVertexCount : 0, 3),
+                    aTexCoords (aTexCoordsData, aTexCoordsData ? aVertexCount : 0, 2);
+
     // select appropriate reader for reading the segment data
     JtData_Reader* aDataReaderPtr;
     if (aCompressedSize > 0)
@@ -347,33 +603,30 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
       // use the original reader otherwise
       aDataReaderPtr = &theReader;
 
-    // determine number of vertices
-    VertexData::SizeType aVertexCount = aPimitiveListIndices.Last();
-
-    // allocate output storage
-    JtData_CompVector <Jt_F32, VertexData::SizeType, VertexData::CompCountType>
-      aVertices (aVertexCount                     , 3),
-      aNormals  (aNormalBinding ? aVertexCount : 0, 3);
-
-    // read the data
+    // read the data; the vertex parameters are interleaved
+    // in order of texture coordinates, color, normal and coords
     for (VertexData::SizeType i = 0; i < aVertexCount; i++)
     {
-      if (aNormalBinding == VertexBinding1::PerVertex)
+      if (hasTexCoords)
+        aDataReaderPtr->ReadArray (aTexCoords[i]);
+
+      if (hasColors)
+        aDataReaderPtr->ReadArray (aColors[i]);
+
+      if (hasNormals)
         aDataReaderPtr->ReadArray (aNormals[i]);
 
       aDataReaderPtr->ReadArray   (aVertices[i]);
     }
 
-    // move the data to the output vectors
-    myVertices << reinterpret_cast<VertexData&> (aVertices);
-    myNormals  << reinterpret_cast<VertexData&> (aNormals);
-
     // free the JtData_Inflate reader if it was used
     if (aDataReaderPtr != &theReader)
       delete aDataReaderPtr;
 
     // generate conventional OpenGL arrays
-    myIndices.Allocate (aNbFaces * 3);
+    int32_t* anIndices = 0L;
+    if (!allocateIndices (aNbFaces * 3, anIndices))
+      return Standard_False;
 
     Jt_I32 aPrimIdx, anOrigin;
     Jt_I32 anOffset1 = 1;
@@ -383,9 +636,9 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
     {
       for (anOrigin = aPimitiveListIndices[aPrimIdx]; anOrigin < aPimitiveListIndices[aPrimIdx + 1] - 2; ++anOrigin)
       {
-        myIndices[aVertIdx++] = anOrigin;
-        myIndices[aVertIdx++] = anOrigin + anOffset1;
-        myIndices[aVertIdx++] = anOrigin + anOffset2;
+        anIndices[aVertIdx++] = anOrigin;
+        anIndices[aVertIdx++] = anOrigin + anOffset1;
+        anIndices[aVertIdx++] = anOrigin + anOffset2;
         anOffset1 ^= 1 ^ 2;
         anOffset2 ^= 1 ^ 2;
       }
@@ -405,10 +658,9 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
       JtDecode_VertexData::Handle anEncodedVertices =
         JtDecode_VertexData::LoadQuantizedCoords (theReader);
 
-      if (!anEncodedVertices)
+      if (!anEncodedVertices
+       || !decodeParameter (Parameter_Vertices, anEncodedVertices, 0L, aDecodeTasks, aDecodeArena))
         return Standard_False;
-
-      aDecodeTasks.Run (VertexDataDecodeTask (anEncodedVertices, myVertices));
     }
 
     // read unique vertex normals data if present and start decoding it
@@ -417,10 +669,9 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
       JtDecode_VertexData::Handle anEncodedNormals =
         JtDecode_VertexData::LoadQuantizedNormals (theReader);
 
-      if (!anEncodedNormals)
+      if (!anEncodedNormals
+       || !decodeParameter (Parameter_Normals, anEncodedNormals, 0L, aDecodeTasks, aDecodeArena))
         return Standard_False;
-
-      aDecodeTasks.Run (VertexDataDecodeTask (anEncodedNormals, myNormals));
     }
 
     /*
@@ -429,6 +680,7 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
      * and encode data.
      */
     {
+      JtData_Arena::Scope anArenaScope (&aDecodeArena);
       JtDecode_Int32CDP anEncodedVertexDataIndices;
       if (!anEncodedVertexDataIndices.Load1 (theReader))
           return Standard_False;
@@ -437,7 +689,9 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
     }
 
     // generate conventional OpenGL arrays
-    myIndices.Allocate (aNbFaces * 3);
+    int32_t* anIndices = 0L;
+    if (!allocateIndices (aNbFaces * 3, anIndices))
+      return Standard_False;
 
     Jt_I32 aPrimIdx, anOrigin;
     Jt_I32 anOffset1 = 1;
@@ -447,9 +701,9 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
     {
       for (anOrigin = aPimitiveListIndices[aPrimIdx]; anOrigin < aPimitiveListIndices[aPrimIdx + 1] - 2; ++anOrigin)
       {
-        myIndices[aVertIdx++] = aVertexDataIndices[anOrigin];
-        myIndices[aVertIdx++] = aVertexDataIndices[anOrigin + anOffset1];
-        myIndices[aVertIdx++] = aVertexDataIndices[anOrigin + anOffset2];
+        anIndices[aVertIdx++] = aVertexDataIndices[anOrigin];
+        anIndices[aVertIdx++] = aVertexDataIndices[anOrigin + anOffset1];
+        anIndices[aVertIdx++] = aVertexDataIndices[anOrigin + anOffset2];
         anOffset1 ^= 1 ^ 2;
         anOffset2 ^= 1 ^ 2;
       }
@@ -463,23 +717,59 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readVertexBasedShapeCompressedRepDat
 }
 
 //=======================================================================
-//function : readTopologicallyCompessedData
-//purpose  : Read and decode Topologically Compressed Rep Data collection
+//function : readTopoMeshData
+//purpose  : Read and decode Topologically Compressed Rep Data (tri-strip
+//           sets) or TopoMesh Compressed Rep Data V1 collection
 //=======================================================================
-Standard_Boolean JtElement_ShapeLOD_Vertex::readTopologicallyCompressedData (JtData_Reader& theReader)
+Standard_Boolean JtElement_ShapeLOD_Vertex::readTopoMeshData (
+  JtData_Reader&         theReader,
+  const Standard_Boolean theIsTopologicallyCompressed)
 {
+  // Arena for temporary decoding buffers, released when the segment is read;
+  // it must outlive the decoding tasks and their results
+  JtData_Arena aDecodeArena;
+
+  // Indices of vertex coords and attributes for each triangle corner
+  // and the unique coords and attributes they refer to
+  IndicesVec aVertexIndices, aNormalIndices;
+  VertexData aUniqueVertices, aUniqueNormals, aUniqueColors, aUniqueTexCoords;
+
+  // Primitives of TopoMesh Compressed Rep Data
+  JtDecode_Int32CDP anEncodedPrimitiveListIndices, anEncodedVertexListIndices;
+  Jt_VecI32 aPrimitiveListIndices, aVertexListIndices;
+
   // Create a TBB task group for parallel decoding of read data
-  JtData_Parallel::TaskGroup aDecodeTasks;
+  // and a scheduler for parallel decoding of CDP packages
+  JtData_Parallel::TaskGroup      aDecodeTasks;
+  JtDecode_Int32CDPScheduler<100> aCDPScheduler;
 
-  // Read mesh data and start decoding it
-  JtDecode_MeshCoderDriver::InputData::Handle aMeshData =
-    JtDecode_MeshCoderDriver::LoadInputData (theReader);
+  if (theIsTopologicallyCompressed)
+  {
+    // Read mesh data and start decoding it
+    JtDecode_MeshCoderDriver::InputData::Handle aMeshData =
+      JtDecode_MeshCoderDriver::LoadInputData (theReader);
 
-  if (!aMeshData)
-    return Standard_False;
+    if (!aMeshData)
+      return Standard_False;
 
-  IndicesVec aVertexIndices, aNormalIndices;
-  aDecodeTasks.Run (MeshDecodeTask (aMeshData, aVertexIndices, aNormalIndices));
+    aDecodeTasks.Run (MeshDecodeTask (aMeshData, aVertexIndices, aNormalIndices, aDecodeArena));
+  }
+  else
+  {
+    // Primitive List Indices is a vector of indices into the Vertex List Indices
+    // marking the start of primitives (triangle strips); Vertex List Indices is
+    // a vector of indices into the vertex records. Both use the Int32 version
+    // of the CODEC to compress and encode data.
+    if (!anEncodedPrimitiveListIndices.Load2 (theReader)
+     || !anEncodedVertexListIndices   .Load2 (theReader))
+    {
+      return Standard_False;
+    }
+
+    JtData_Arena::Scope anArenaScope (&aDecodeArena);
+    aCDPScheduler.Run (anEncodedPrimitiveListIndices, aPrimitiveListIndices, JtDecode_Unpack_Stride1);
+    aCDPScheduler.Run (anEncodedVertexListIndices,    aVertexListIndices,    JtDecode_Unpack_StripIdx);
+  }
 
   ///////////////////////////////////////////////////////////////////
   // Topologically Compressed Vertex Records data collection
@@ -503,12 +793,23 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readTopologicallyCompressedData (JtD
   if (!theReader.ReadI32 (aNumberOfAttr))
     return Standard_False;
 
-  Standard_Boolean aCoordsPresent = (aVertexBindings.NbVertexCoordComponents() > 0);
-  Standard_Boolean aNormalsPresent = aVertexBindings.IsNormalBinding();
+  Standard_Boolean aCoordsPresent    = (aVertexBindings.NbVertexCoordComponents() > 0);
+  Standard_Boolean aNormalsPresent   = aVertexBindings.IsNormalBinding();
+  Standard_Boolean aColorsPresent    = (aVertexBindings.NbColorComponents() > 0);
+  Standard_Boolean aTexCoordsPresent = (aVertexBindings.NbTextCoordComponents (0) > 0);
+  Standard_Boolean anAttrsPresent    = aNormalsPresent || aColorsPresent || aTexCoordsPresent;
+
+  // The coords and attributes used as they are decoded go straight to the output
+  // vectors; if both are present in a tri-strip set, the unique ones are decoded
+  // to temporary vectors and their combinations are gathered to the output vectors
+  const Standard_Boolean toGather = theIsTopologicallyCompressed && aCoordsPresent && anAttrsPresent;
+
+  // Attributes of TopoMesh vertex records are indexed as the coords,
+  // so those of another count are not used
+  const Standard_Boolean toIndexAsCoords = !theIsTopologicallyCompressed && aCoordsPresent;
 
   // Read vertex coords data and start decoding it
   int32_t aUniqueVerticesCount = 0;
-  VertexData aUniqueVertices;
   if (aCoordsPresent)
   {
     JtDecode_VertexData::Handle anEncodedVertices =
@@ -518,11 +819,13 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readTopologicallyCompressedData (JtD
       return Standard_False;
 
     aUniqueVerticesCount = anEncodedVertices->GetOutVertexCount();
-    aDecodeTasks.Run (VertexDataDecodeTask (anEncodedVertices, aUniqueVertices));
+    if (!decodeParameter (Parameter_Vertices, anEncodedVertices, toGather ? &aUniqueVertices : 0L,
+                          aDecodeTasks, aDecodeArena))
+      return Standard_False;
   }
 
   // Read vertex normals data and start decoding it
-  VertexData aUniqueNormals;
+  int32_t aUniqueNormalsCount = 0;
   if (aNormalsPresent)
   {
     JtDecode_VertexData::Handle anEncodedNormals =
@@ -531,81 +834,395 @@ Standard_Boolean JtElement_ShapeLOD_Vertex::readTopologicallyCompressedData (JtD
     if (!anEncodedNormals)
       return Standard_False;
 
-    aDecodeTasks.Run (VertexDataDecodeTask (anEncodedNormals, aUniqueNormals));
+    aUniqueNormalsCount = anEncodedNormals->GetOutVertexCount();
+    if (toIndexAsCoords && aUniqueNormalsCount != aUniqueVerticesCount)
+      WARNING ("Warning: " + aUniqueNormalsCount + " normals do not match "
+               + aUniqueVerticesCount + " vertices, ignored");
+    else if (!decodeParameter (Parameter_Normals, anEncodedNormals, toGather ? &aUniqueNormals : 0L,
+                               aDecodeTasks, aDecodeArena))
+      return Standard_False;
+  }
+
+  // Read vertex colors data and start decoding it
+  int32_t aUniqueColorsCount = 0;
+  if (aColorsPresent)
+  {
+    JtDecode_VertexData::Handle anEncodedColors =
+      JtDecode_VertexData::LoadCompressedColors (theReader);
+
+    if (!anEncodedColors)
+      return Standard_False;
+
+    aUniqueColorsCount = anEncodedColors->GetOutVertexCount();
+    if (toIndexAsCoords && aUniqueColorsCount != aUniqueVerticesCount)
+      WARNING ("Warning: " + aUniqueColorsCount + " colors do not match "
+               + aUniqueVerticesCount + " vertices, ignored");
+    else if (!decodeParameter (Parameter_Colors, anEncodedColors, toGather ? &aUniqueColors : 0L,
+                               aDecodeTasks, aDecodeArena))
+      return Standard_False;
   }
 
-  // Create a temporary vector of maps used to map combination of coord index and normal index
-  // to a single common index if both coords and normals are present
-  typedef std::map<int32_t, int32_t> Map;
-  JtData_Vector<Map, int32_t> aMaps;
-  if (aCoordsPresent && aNormalsPresent)
-    aMaps.Allocate (aUniqueVerticesCount);
+  // Read coordinates of the first texture and start decoding them;
+  // the data of other textures, flags and auxiliary fields are not used
+  int32_t aUniqueTexCoordsCount = 0;
+  if (aTexCoordsPresent)
+  {
+    JtDecode_VertexData::Handle anEncodedTexCoords =
+      JtDecode_VertexData::LoadCompressedTexCoords (theReader);
+
+    if (!anEncodedTexCoords)
+      return Standard_False;
+
+    aUniqueTexCoordsCount = anEncodedTexCoords->GetOutVertexCount();
+    if (toIndexAsCoords && aUniqueTexCoordsCount != aUniqueVerticesCount)
+      WARNING ("Warning: " + aUniqueTexCoordsCount + " texture coordinates do not match "
+               + aUniqueVerticesCount + " vertices, ignored");
+    else if (!decodeParameter (Parameter_TexCoords, anEncodedTexCoords, toGather ? &aUniqueTexCoords : 0L,
+                               aDecodeTasks, aDecodeArena))
+      return Standard_False;
+  }
 
   // Wait until all vectors are decoded
+  aCDPScheduler.Wait();
   aDecodeTasks.Wait();
 
-  // If both coords and normals are present,
-  // convert the data from separately indexed vectors of unique coords and normals
-  // to vectors representing unique combinations of coords and normals with each
-  // combination indexed by a single index
-  if (aCoordsPresent && aNormalsPresent)
+  // Vertex records of TopoMesh Compressed Rep Data are indexed directly,
+  // so the coords and attributes are used as is with triangulated strips
+  if (!theIsTopologicallyCompressed)
+  {
+    // the strips index the vertex records, i.e. the coords if present,
+    // otherwise each of the attributes
+    Jt_I32 aNbVertices = aCoordsPresent ? aUniqueVerticesCount : aNumberOfVert;
+    if (!aCoordsPresent && aNormalsPresent)
+      aNbVertices = Min (aNbVertices, aUniqueNormalsCount);
+    if (!aCoordsPresent && aColorsPresent)
+      aNbVertices = Min (aNbVertices, aUniqueColorsCount);
+    if (!aCoordsPresent && aTexCoordsPresent)
+      aNbVertices = Min (aNbVertices, aUniqueTexCoordsCount);
+
+    return triangulateStrips (aPrimitiveListIndices, aVertexListIndices, aNbVertices);
+  }
+
+  // If both coords and attributes (normals, colors, texture coordinates) are present,
+  // convert the data from separately indexed vectors of unique coords and attributes
+  // to vectors representing unique combinations of coords and attributes with each
+  // combination indexed by a single index; all the attributes share the same indices
+  if (toGather)
   {
     // build the output single vector of indices
     // and a auxiliary vector of indices of unique combinations of source
-    // indices of coords and normals
-    myIndices.Allocate (aVertexIndices.Count());
+    // indices of coords and normals;
+    // pairs are numbered in order of their first occurrence
+    int32_t* anIndices = 0L;
+    if (!allocateIndices (aVertexIndices.Count(), anIndices))
+      return Standard_False;
+
     IndicesVec anIdxIndices (aVertexIndices.Count());
     int32_t aUniquePairsCount = 0;
-
-    for (int32_t anIdxIdx = 0; anIdxIdx < aVertexIndices.Count(); anIdxIdx++)
     {
-      int32_t aVertexIdx = aVertexIndices[anIdxIdx];
-      int32_t aNormalIdx = aNormalIndices[anIdxIdx];
-
-      Map& aMap = aMaps[aVertexIdx];
-      Map::iterator anIt = aMap.find (aNormalIdx);
-
-      if (anIt == aMap.end())
-      {
-        aMap.insert (anIt, Map::value_type (aNormalIdx, aUniquePairsCount));
-        anIdxIndices[aUniquePairsCount] = anIdxIdx;
-        myIndices[anIdxIdx] = aUniquePairsCount++;
-      }
-      else
+      IndexPairMap aPairMap (aUniqueVerticesCount);
+      for (int32_t anIdxIdx = 0; anIdxIdx < aVertexIndices.Count(); anIdxIdx++)
       {
-        myIndices[anIdxIdx] = anIt->second;
+        int32_t aPairIdx = aPairMap.FindOrAdd (aVertexIndices[anIdxIdx],
+                                               aNormalIndices[anIdxIdx],
+                                               aUniquePairsCount);
+        if (aPairIdx == aUniquePairsCount)
+          anIdxIndices[aUniquePairsCount++] = anIdxIdx;
+
+        anIndices[anIdxIdx] = aPairIdx;
       }
     }
 
-    // free the memory used by the vector of maps since it will not be needed anymore
-    aMaps.Free();
+    // build the output vectors of coords and attributes using the auxiliary vector
+    Jt_F32 *aVerticesData = 0L, *aNormalsData = 0L, *aColorsData = 0L, *aTexCoordsData = 0L;
+    if (!allocateParameter (Parameter_Vertices, aUniquePairsCount, aUniqueVertices.CompCount(), aVerticesData)
+     || (aNormalsPresent
+      && !allocateParameter (Parameter_Normals,   aUniquePairsCount, aUniqueNormals.CompCount(),   aNormalsData))
+     || (aColorsPresent
+      && !allocateParameter (Parameter_Colors,    aUniquePairsCount, aUniqueColors.CompCount(),    aColorsData))
+     || (aTexCoordsPresent
+      && !allocateParameter (Parameter_TexCoords, aUniquePairsCount, aUniqueTexCoords.CompCount(), aTexCoordsData)))
+    {
+      return Standard_False;
+    }
+
+    const VertexData::Ref
+      aVertices  (aVerticesData,  aVerticesData  ? aUniquePairsCount : 0, aUniqueVertices .CompCount()),
+      aNormals   (aNormalsData,   aNormalsData   ? aUniquePairsCount : 0, aUniqueNormals  .CompCount()),
+      aColors    (aColorsData,    aColorsData    ? aUniquePairsCount : 0, aUniqueColors   .CompCount()),
+      aTexCoords (aTexCoordsData, aTexCoordsData ? aUniquePairsCount : 0, aUniqueTexCoords.CompCount());
+
+    JtData_Parallel::For (0, aUniquePairsCount,
+                          UniquePairsGatherTask (aUniqueVertices, aUniqueNormals, aUniqueColors, aUniqueTexCoords,
+                                                 aVertexIndices,  aNormalIndices, anIdxIndices,
+                                                 aVertices,       aNormals,       aColors,       aTexCoords));
+  }
+
+  // If only coords are present, use the decoded coords and their indices
+  else if (aCoordsPresent)
+    return moveIndices (aVertexIndices);
+
+  // If only attributes are present, use the decoded attributes and their indices
+  else if (anAttrsPresent)
+    return moveIndices (aNormalIndices);
+
+  // Success
+  return Standard_True;
+}
+
+//=======================================================================
+//function : triangulateStrips
+//purpose  : Convert triangle strips given by primitive list indices into
+//           a vertex list to the output triangles
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::triangulateStrips (const Jt_VecI32& thePrimitiveListIndices,
+                                                               const Jt_VecI32& theVertexListIndices,
+                                                               const Jt_I32     theNbVertices)
+{
+  const Jt_I32 aNbPrimitives = thePrimitiveListIndices.Count() - 1;
+  if (aNbPrimitives <= 0)
+    return Standard_True;
+
+  // count the triangles and check the strip bounds
+  Jt_I32 aNbFaces = 0;
+  for (Jt_I32 aPrimIdx = 0; aPrimIdx < aNbPrimitives; aPrimIdx++)
+  {
+    const Jt_I32 aFirst = thePrimitiveListIndices[aPrimIdx];
+    const Jt_I32 aLast  = thePrimitiveListIndices[aPrimIdx + 1];
+    if (aFirst < 0 || aLast < aFirst || aLast > theVertexListIndices.Count())
+      return Standard_False;
 
-    // build the output vectors of coords and normals using the auxiliary vector
-    myVertices.Allocate (aUniquePairsCount, aUniqueVertices.CompCount());
-    myNormals .Allocate (aUniquePairsCount, aUniqueNormals.CompCount());
+    aNbFaces += Max (aLast - aFirst - 2, 0);
+  }
+
+  // check the vertex indices
+  for (Jt_I32 anIdx = 0; anIdx < theVertexListIndices.Count(); anIdx++)
+  {
+    if (theVertexListIndices[anIdx] < 0 || theVertexListIndices[anIdx] >= theNbVertices)
+      return Standard_False;
+  }
 
-    for (int32_t aUniquePairIdx = 0; aUniquePairIdx < aUniquePairsCount; aUniquePairIdx++)
+  // generate conventional OpenGL arrays
+  int32_t* aTriangles = 0L;
+  if (!allocateIndices (aNbFaces * 3, aTriangles))
+    return Standard_False;
+
+  Jt_I32 anOffset1 = 1;
+  Jt_I32 anOffset2 = 2;
+  IndicesVec::SizeType aVertIdx = 0;
+  for (Jt_I32 aPrimIdx = 0; aPrimIdx < aNbPrimitives; aPrimIdx++)
+  {
+    for (Jt_I32 anOrigin = thePrimitiveListIndices[aPrimIdx]; anOrigin < thePrimitiveListIndices[aPrimIdx + 1] - 2; ++anOrigin)
     {
-      int32_t anIdxIdx = anIdxIndices[aUniquePairIdx];
-      myVertices[aUniquePairIdx] = aUniqueVertices[aVertexIndices[anIdxIdx]];
-      myNormals [aUniquePairIdx] = aUniqueNormals [aNormalIndices[anIdxIdx]];
+      aTriangles[aVertIdx++] = theVertexListIndices[anOrigin];
+      aTriangles[aVertIdx++] = theVertexListIndices[anOrigin + anOffset1];
+      aTriangles[aVertIdx++] = theVertexListIndices[anOrigin + anOffset2];
+      anOffset1 ^= 1 ^ 2;
+      anOffset2 ^= 1 ^ 2;
     }
   }
 
-  // If only coords are present, use the coords vector and its indices
-  else if (aCoordsPresent)
+  return Standard_True;
+}
+
+//=======================================================================
+//function : allocateIndices
+//purpose  : Allocate the output indices in a buffer of the sink or in the element
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::allocateIndices (const int32_t theCount,
+                                                             int32_t*&     theIndices)
+{
+  theIndices = 0L;
+  if (theCount <= 0)
+    return Standard_True;
+
+  if (mySink)
+  {
+    theIndices = mySink->IndicesBuffer (*this, theCount);
+    myIsPassedToSink = Standard_True;
+  }
+  else
+  {
+    // the output outlives the decoding arena
+    JtData_Arena::Scope aHeapScope (0L);
+    myIndices.Allocate (theCount);
+    theIndices = myIndices.Data();
+  }
+
+  return theIndices != 0L;
+}
+
+//=======================================================================
+//function : allocateParameter
+//purpose  : Allocate the output values of a vertex parameter in a buffer
+//           of the sink or in the element
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::allocateParameter (const Parameter theParameter,
+                                                               const int32_t   theCount,
+                                                               const int32_t   theCompCount,
+                                                               float*&         theValues)
+{
+  theValues = 0L;
+  if (theCount <= 0)
+    return Standard_True;
+
+  if (mySink)
   {
-    myVertices << aUniqueVertices;
-    myIndices  << aVertexIndices;
+    theValues = mySink->ParameterBuffer (*this, theParameter, theCount, theCompCount);
+    myIsPassedToSink = Standard_True;
+  }
+  else
+  {
+    VertexData* aParams[] = {&myVertices, &myNormals, &myColors, &myTexCoords};
+
+    // the output outlives the decoding arena
+    JtData_Arena::Scope aHeapScope (0L);
+    aParams[theParameter]->Allocate (theCount, theCompCount);
+    theValues = aParams[theParameter]->Data();
   }
 
-  // If only normals are present, use the normals vector and its indices
-  else if (aNormalsPresent)
+  return theValues != 0L;
+}
+
+//=======================================================================
+//function : decodeParameter
+//purpose  : Start decoding of the loaded data of a vertex parameter
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::decodeParameter (const Parameter                           theParameter,
+                                                             JtData_SingleHandle<JtDecode_VertexData>& theData,
+                                                             VertexData*                               theUnique,
+                                                             JtData_Parallel::TaskGroup&               theTasks,
+                                                             JtData_Arena&                             theArena)
+{
+  const int32_t aCount     = theData->GetOutVertexCount();
+  const int32_t aCompCount = theData->GetOutCompCount();
+
+  float* aValues = 0L;
+  if (theUnique)
   {
-    myNormals << aUniqueNormals;
-    myIndices << aNormalIndices;
+    // the unique values are released before the arena
+    JtData_Arena::Scope anArenaScope (&theArena);
+    theUnique->Allocate (aCount, aCompCount);
+    aValues = theUnique->Data();
   }
+  else if (!allocateParameter (theParameter, aCount, aCompCount, aValues))
+    return Standard_False;
 
-  // Success
+  theTasks.Run (VertexDataDecodeTask (theData, VertexData::Ref (aValues, aValues ? aCount : 0, aCompCount), theArena));
+  return Standard_True;
+}
+
+//=======================================================================
+//function : moveIndices
+//purpose  : Move decoded indices to the output or copy them to the sink
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::moveIndices (IndicesVec& theIndices)
+{
+  if (!mySink)
+  {
+    myIndices << theIndices;
+    return Standard_True;
+  }
+
+  // the number of indices is known only when they are decoded
+  int32_t* anIndices = 0L;
+  if (!allocateIndices (theIndices.Count(), anIndices))
+    return Standard_False;
+
+  if (anIndices)
+    memcpy (anIndices, theIndices.Data(), sizeof (int32_t) * static_cast<Standard_Size> (theIndices.Count()));
+
+  return Standard_True;
+}
+
+//=======================================================================
+//function : finishSink
+//purpose  : Let the sink know that the reading is finished and reset it
+//=======================================================================
+void JtElement_ShapeLOD_Vertex::finishSink (const Standard_Boolean theIsDone)
+{
+  if (mySink && myIsPassedToSink)
+    mySink->Finish (*this, theIsDone);
+
+  mySink = 0L;
+}
+
+//=======================================================================
+//function : OptimizeVertexCache
+//purpose  : Reorder triangles and vertices for cache efficiency
+//=======================================================================
+Standard_Boolean JtElement_ShapeLOD_Vertex::OptimizeVertexCache (CacheStatistics& theStats)
+{
+  // The vertices are given by the first present parameters vector
+  const VertexData* aParams[] = {&myVertices, &myNormals, &myColors, &myTexCoords};
+  int32_t aNbVertices = 0;
+  for (Standard_Size k = 0; k < 4 && aNbVertices == 0; k++)
+    aNbVertices = aParams[k]->Count();
+
+  const Standard_Size aNbIndices = static_cast <Standard_Size> (myIndices.Count()) / 3 * 3;
+
+  theStats = CacheStatistics();
+  theStats.NbTriangles = aNbIndices / 3;
+  if (aNbIndices == 0 || aNbVertices == 0)
+    return Standard_False;
+
+  // Renumbering is only valid if all the present parameters are given per vertex
+  for (Standard_Size k = 0; k < 4; k++)
+  {
+    if (!aParams[k]->IsEmpty() && aParams[k]->Count() != aNbVertices)
+      return Standard_False;
+  }
+
+  theStats.ACMRBefore = JtDecode_VertexCache::ACMR (myIndices.Data(), aNbIndices, aNbVertices);
+  theStats.ACMRAfter  = theStats.ACMRBefore;
+
+  // The results outlive any decoding arena of the caller
+  JtData_Arena::Scope aHeapScope (0L);
+
+  IndicesVec anOptimized (static_cast <int32_t> (aNbIndices));
+  if (anOptimized.IsEmpty()
+   || !JtDecode_VertexCache::OptimizeTriangles (myIndices.Data(), aNbIndices, aNbVertices, anOptimized.Data()))
+  {
+    return Standard_False;
+  }
+
+  std::vector<int32_t> aRemap (aNbVertices);
+  JtDecode_VertexCache::OptimizeFetch (anOptimized.Data(), aNbIndices, aNbVertices, &aRemap[0]);
+
+  myIndices << anOptimized;
+  remapVertexData (myVertices,  aRemap);
+  remapVertexData (myNormals,   aRemap);
+  remapVertexData (myColors,    aRemap);
+  remapVertexData (myTexCoords, aRemap);
+
+  theStats.ACMRAfter = JtDecode_VertexCache::ACMR (myIndices.Data(), aNbIndices, aNbVertices);
   return Standard_True;
 }
+
+//=======================================================================
+//function : OptimizeVertexCache
+//purpose  : Optimize vertex shape LODs among the given objects in parallel
+//=======================================================================
+void JtElement_ShapeLOD_Vertex::OptimizeVertexCache (const JtData_Object::VectorOfObjects& theObjects,
+                                                     CacheStatistics&                      theStats)
+{
+  theStats = CacheStatistics();
+  if (theObjects.IsEmpty())
+    return;
+
+  std::vector<CacheStatistics> aStats (theObjects.Count());
+  JtData_Parallel::For (Standard_Size (0), theObjects.Count(), VertexCacheTask (theObjects, aStats));
+
+  for (Standard_Size i = 0; i < aStats.size(); i++)
+  {
+    theStats.ACMRBefore  += aStats[i].ACMRBefore * aStats[i].NbTriangles;
+    theStats.ACMRAfter   += aStats[i].ACMRAfter  * aStats[i].NbTriangles;
+    theStats.NbTriangles += aStats[i].NbTriangles;
+  }
+
+  if (theStats.NbTriangles > 0)
+  {
+    theStats.ACMRBefore /= theStats.NbTriangles;
+    theStats.ACMRAfter  /= theStats.NbTriangles;
+  }
+}
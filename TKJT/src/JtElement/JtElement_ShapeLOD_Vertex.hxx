@@ -22,6 +22,12 @@
 #include <JtData_Types.hxx>
 #include <JtData_CompVector.hxx>
 
+class JtElement_ShapeLOD_Sink;
+class JtDecode_VertexData;
+class JtData_Arena;
+template <class Type> class JtData_SingleHandle;
+namespace JtData_Parallel { class TaskGroup; }
+
 //! Vertex Shape LOD Element represents LODs defined by collections of vertices.
 class JtElement_ShapeLOD_Vertex : public JtElement_ShapeLOD_Base
 {
@@ -86,13 +92,50 @@ public:
     Standard_Size    NbTextCoordComponents (Standard_Size theTexture);
   };
 
+  //! Vertex cache efficiency of the triangle list before and after
+  //! its optimization, as ACMR (vertex cache misses per triangle).
+  struct CacheStatistics
+  {
+    Standard_Real ACMRBefore;
+    Standard_Real ACMRAfter;
+    Standard_Size NbTriangles;
+
+    CacheStatistics() : ACMRBefore (0.), ACMRAfter (0.), NbTriangles (0) {}
+  };
+
+  //! Vertex parameters of the LOD.
+  enum Parameter
+  {
+    Parameter_Vertices,  //!< vertex coordinates
+    Parameter_Normals,   //!< normals
+    Parameter_Colors,    //!< colors
+    Parameter_TexCoords  //!< coordinates of the first texture
+  };
+
+  //! Receiver of decoded mesh data (see JtElement_ShapeLOD_Sink).
+  typedef JtElement_ShapeLOD_Sink Sink;
+
 public:
+  //! Default constructor.
+  Standard_EXPORT JtElement_ShapeLOD_Vertex();
+
   //! Read this entity from a JT file.
   Standard_EXPORT virtual Standard_Boolean Read (JtData_Reader &theReader);
 
   //! Dump this entity.
   Standard_EXPORT virtual Standard_Integer Dump (Standard_OStream& S) const;
 
+  //! Return size of the decoded vectors in bytes.
+  Standard_EXPORT virtual Standard_Size MemorySize() const;
+
+  //! Return false if the decoded data was written to buffers of a sink.
+  Standard_EXPORT virtual Standard_Boolean IsCacheable() const;
+
+  //! Set the receiver of the decoded data for the next reading of this element;
+  //! it is reset when the reading is done. The vectors of the element stay empty
+  //! while the data is written to the buffers provided by the sink.
+  void SetSink (Sink* theSink) { mySink = theSink; }
+
   //! Indices into the vertex parameters arrays.
   const IndicesVec& Indices()  const { return myIndices; }
 
@@ -102,24 +145,90 @@ public:
   //! Normals; can be empty if there is no normals data.
   const VertexData& Normals()  const { return myNormals; }
 
+  //! Colors (RGB or RGBA); can be empty if there is no colors data.
+  const VertexData& Colors()   const { return myColors; }
+
+  //! Coordinates of the first texture; can be empty if there is no texture coordinates data.
+  const VertexData& TexCoords() const { return myTexCoords; }
+
+  //! Reorder triangles for post-transform vertex cache efficiency and
+  //! renumber vertices (with all their parameters) in order of first use
+  //! for fetch locality. The mesh stays the same, but it is modified in place,
+  //! so it should not be applied to objects shared by a segment cache.
+  //! @return Standard_False if there is nothing to optimize, the indices are invalid
+  //!         or some of the vertex parameters are not given per vertex.
+  Standard_EXPORT Standard_Boolean OptimizeVertexCache (CacheStatistics& theStats);
+
+  //! Optimize vertex shape LODs among the given objects in parallel;
+  //! other objects are skipped. Returns statistics over all optimized
+  //! LODs with ACMR values weighted by numbers of triangles.
+  Standard_EXPORT static void OptimizeVertexCache (const JtData_Object::VectorOfObjects& theObjects,
+                                                   CacheStatistics&                      theStats);
+
   DEFINE_STANDARD_RTTI(JtElement_ShapeLOD_Vertex)
   DEFINE_OBJECT_CLASS (JtElement_ShapeLOD_Vertex)
 
 protected:
   class VertexDataDecodeTask;
   class MeshDecodeTask;
+  class IndexPairMap;
+  class UniquePairsGatherTask;
+  class VertexCacheTask;
 
   Standard_Boolean readVertexShapeLODData (
     JtData_Reader&   theReader,
     Standard_Boolean theIsTriStripSet = Standard_False);
 
   Standard_Boolean readVertexBasedShapeCompressedRepData (JtData_Reader& theReader);
-  Standard_Boolean readTopologicallyCompressedData       (JtData_Reader& theReader);
+
+  //! Read Topologically Compressed Rep Data of tri-strip sets
+  //! or TopoMesh Compressed Rep Data V1 of other vertex shapes.
+  Standard_Boolean readTopoMeshData (JtData_Reader&         theReader,
+                                     const Standard_Boolean theIsTopologicallyCompressed);
+
+  //! Convert triangle strips given by indices of their starts
+  //! in the vertex list to the output list of triangles.
+  //! Fails if the vertex list refers to a vertex out of [0, theNbVertices).
+  Standard_Boolean triangulateStrips (const Jt_VecI32& thePrimitiveListIndices,
+                                      const Jt_VecI32& theVertexListIndices,
+                                      const Jt_I32     theNbVertices);
+
+  //! Allocate the output indices: in a buffer provided by the sink if it is set,
+  //! otherwise in the element. Returns false if the buffer is not provided.
+  Standard_Boolean allocateIndices (const int32_t theCount, int32_t*& theIndices);
+
+  //! Allocate the output values of the given vertex parameter: in a buffer provided
+  //! by the sink if it is set, otherwise in the element.
+  //! Returns false if the buffer is not provided.
+  Standard_Boolean allocateParameter (const Parameter theParameter,
+                                      const int32_t   theCount,
+                                      const int32_t   theCompCount,
+                                      float*&         theValues);
+
+  //! Start decoding of the loaded data of the given vertex parameter in the task group:
+  //! to the output values (see allocateParameter()) or, if given, to the unique values
+  //! allocated from the arena. Returns false if no buffer is provided for the output.
+  Standard_Boolean decodeParameter (const Parameter                           theParameter,
+                                    JtData_SingleHandle<JtDecode_VertexData>& theData,
+                                    VertexData*                               theUnique,
+                                    JtData_Parallel::TaskGroup&               theTasks,
+                                    JtData_Arena&                             theArena);
+
+  //! Move the decoded indices to the output indices, or copy them to the buffer of the sink.
+  Standard_Boolean moveIndices (IndicesVec& theIndices);
+
+  //! Let the sink if any know that the reading is finished and reset it.
+  void finishSink (const Standard_Boolean theIsDone);
 
 protected:
-  IndicesVec myIndices;  //!< Indices into the vertex parameters arrays
-  VertexData myVertices; //!< vertex coordinates
-  VertexData myNormals;  //!< normals; can be empty if there is no normals data
+  IndicesVec myIndices;   //!< Indices into the vertex parameters arrays
+  VertexData myVertices;  //!< vertex coordinates
+  VertexData myNormals;   //!< normals; can be empty if there is no normals data
+  VertexData myColors;    //!< colors; can be empty if there is no colors data
+  VertexData myTexCoords; //!< coordinates of the first texture; can be empty
+
+  Sink*            mySink;           //!< receiver of the data being read, if any
+  Standard_Boolean myIsPassedToSink; //!< the decoded data was written to buffers of a sink
 };
 
 DEFINE_STANDARD_HANDLE(JtElement_ShapeLOD_Vertex, JtElement_ShapeLOD_Base)
@@ -55,6 +55,7 @@ Standard_Boolean JtProperty_LateLoaded::Read (JtData_Reader& theReader)
     }
   }
 
+  mySegGUID  = aGUID;
   mySegModel = theReader.Model()->FindSegment (aGUID, mySegOffset);
 
   return Standard_True;
@@ -30,10 +30,20 @@ public:
   Standard_EXPORT virtual Standard_Integer Dump (Standard_OStream& theStream) const;
 
   //! Load object from the referenced JT file segment.
-  void Load() { myDefferedObject = mySegModel->ReadSegment (mySegOffset); }
+  //! Decoded mesh data is passed to the given sink if any (see JtData_Model::ReadSegment()).
+  void Load (JtElement_ShapeLOD_Sink* theSink = 0L)
+  {
+    myDefferedObject = mySegModel->ReadSegment (mySegOffset, theSink);
+  }
 
   Handle(JtData_Object) DefferedObject() { return myDefferedObject; }
 
+  //! Return the model containing the referenced JT file segment.
+  const Handle(JtData_Model)& SegmentModel() const { return mySegModel; }
+
+  //! Return GUID of the referenced JT file segment.
+  const Jt_GUID& SegmentGUID() const { return mySegGUID; }
+
   void Unload() { myDefferedObject.Nullify(); }
 
   DEFINE_STANDARD_RTTI(JtProperty_LateLoaded)
@@ -41,7 +51,8 @@ public:
 
 protected:
   Handle(JtData_Model) mySegModel;
-  Jt_I32               mySegOffset;
+  Jt_U64               mySegOffset;
+  Jt_GUID              mySegGUID;
 
   Handle(JtData_Object) myDefferedObject;
 };
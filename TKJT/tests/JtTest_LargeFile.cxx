@@ -0,0 +1,500 @@
+// JT format reading and visualization tools
+// Copyright (C) 2013-2015 OPEN CASCADE SAS
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// Copy of the GNU General Public License is in LICENSE.txt and
+// on <http://www.gnu.org/licenses/>.
+
+// Test of reading segments placed beyond 4 GB in a JT 10 file.
+// A sparse file is written with the TOC and segments at 64-bit offsets
+// (one of them crossing the 4 GB boundary, one at an offset equal to
+// the offset of a low segment truncated to 32 bits); the segments are
+// read back with JtData_Model::ReadSegment(), through late loaded
+// properties (sequentially, in parallel and via the segment cache),
+// and with the positional file reader.
+
+#include <JtData_Model.hxx>
+#include <JtData_PooledReader.hxx>
+#include <JtData_SharedFile.hxx>
+#include <JtNode_Partition.hxx>
+#include <JtNode_Part.hxx>
+#include <JtProperty_LateLoaded.hxx>
+#include <JtProperty_String.hxx>
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#ifdef WNT
+  #include <windows.h>
+  #include <winioctl.h>
+  #include <io.h>
+#endif
+
+namespace
+{
+  const char* const THE_FILE_NAME = "JtTest_LargeFile.jt";
+
+  const Jt_U64 THE_4GB = Jt_U64 (1) << 32;
+
+  //! Late loaded segment written to the test file.
+  struct TestSegment
+  {
+    Jt_GUID          GUID;
+    Jt_U64           Offset;
+    Standard_Integer Type;
+    Standard_Boolean IsCompressed;
+    const char*      Value;
+  };
+
+  const Jt_I32 THE_PART_ID     = 2;
+  const Jt_I32 THE_PROPERTY_ID = 10;
+
+  const Jt_GUID THE_LSG_GUID (0x4a540001, 0x7e57, 0x0001, 1, 2, 3, 4, 5, 6, 7, 8);
+
+  // the low segment and the segment beyond 4 GB have equal offsets truncated to 32 bits,
+  // the compressed segment crosses the 4 GB boundary
+  const TestSegment THE_SEGMENTS[] =
+  {
+    { Jt_GUID (0x4a540002, 0x7e57, 0x0002, 1, 2, 3, 4, 5, 6, 7, 8), 4096,                 7, Standard_False, "low segment"         },
+    { Jt_GUID (0x4a540003, 0x7e57, 0x0003, 1, 2, 3, 4, 5, 6, 7, 8), THE_4GB + 4096,       7, Standard_False, "segment beyond 4 GB" },
+    { Jt_GUID (0x4a540004, 0x7e57, 0x0004, 1, 2, 3, 4, 5, 6, 7, 8), THE_4GB - 8,          4, Standard_True,  "segment across 4 GB" },
+    { Jt_GUID (0x4a540005, 0x7e57, 0x0005, 1, 2, 3, 4, 5, 6, 7, 8), 5 * THE_4GB / 4 + 11, 4, Standard_True,  "compressed segment"  }
+  };
+
+  const Standard_Integer THE_NB_SEGMENTS = sizeof (THE_SEGMENTS) / sizeof (THE_SEGMENTS[0]);
+
+  const Jt_U64 THE_LSG_OFFSET = 256;
+  const Jt_U64 THE_TOC_OFFSET = 3 * THE_4GB / 2 + 3;
+
+  const Jt_GUID THE_EOE_GUID       ("ffffffff-ffff-ffff-ff-ff-ff-ff-ff-ff-ff-ff");
+  const Jt_GUID THE_PARTITION_GUID ("10dd103e-2ac8-11d1-9b-6b-00-80-c7-bb-59-97");
+  const Jt_GUID THE_PART_GUID      ("ce357244-38fb-11d1-a5-06-00-60-97-bd-c6-e1");
+  const Jt_GUID THE_LATELOAD_GUID  ("e0b05be5-fbbd-11d1-a3-a7-00-aa-00-d1-09-54");
+  const Jt_GUID THE_STRING_GUID    ("10dd106e-2ac8-11d1-9b-6b-00-80-c7-bb-59-97");
+
+  Standard_Integer THE_NB_FAILURES = 0;
+
+  //! Report the check result.
+  void check (const bool theCondition, const char* theWhat, const char* theDetail = "")
+  {
+    if (!theCondition)
+    {
+      std::cerr << "FAILED: " << theWhat << " " << theDetail << std::endl;
+      ++THE_NB_FAILURES;
+    }
+  }
+}
+
+//! Writer of little-endian JT data to a memory buffer.
+class JtTest_Writer
+{
+public:
+  void U8  (const Jt_U8  theValue) { myData.push_back (static_cast<char> (theValue)); }
+  void I16 (const Jt_I16 theValue) { put (static_cast<Jt_U16> (theValue), 2); }
+  void I32 (const Jt_I32 theValue) { put (static_cast<Jt_U32> (theValue), 4); }
+  void U32 (const Jt_U32 theValue) { put (theValue, 4); }
+  void U64 (const Jt_U64 theValue) { put (theValue, 8); }
+
+  void F32 (const Jt_F32 theValue)
+  {
+    Jt_U32 aBits;
+    memcpy (&aBits, &theValue, sizeof (aBits));
+    put (aBits, 4);
+  }
+
+  void GUID (const Jt_GUID& theGUID)
+  {
+    U32 (theGUID.data.codes.U32);
+    put (theGUID.data.codes.U16[0], 2);
+    put (theGUID.data.codes.U16[1], 2);
+    for (int i = 0; i < 8; i++)
+      U8 (theGUID.data.codes.U8[i]);
+  }
+
+  void MbString (const char* theString)
+  {
+    const Jt_I32 aLength = static_cast<Jt_I32> (strlen (theString));
+    I32 (aLength);
+    for (Jt_I32 i = 0; i < aLength; i++)
+      put (static_cast<Jt_U8> (theString[i]), 2);
+  }
+
+  void Bytes (const std::vector<char>& theData)
+  {
+    myData.insert (myData.end(), theData.begin(), theData.end());
+  }
+
+  //! Start an element with a placeholder of its length; return the position of the length.
+  Standard_Size BeginElement (const Jt_GUID& theType, const Jt_I32 theObjectID)
+  {
+    const Standard_Size aPos = myData.size();
+    I32 (0);
+    GUID (theType);
+    U8  (0);
+    I32 (theObjectID);
+    return aPos;
+  }
+
+  //! Write the length of the element started at the given position.
+  void EndElement (const Standard_Size thePos)
+  {
+    const Jt_U32 aLength = static_cast<Jt_U32> (myData.size() - thePos - 4);
+    for (int i = 0; i < 4; i++)
+      myData[thePos + i] = static_cast<char> ((aLength >> (8 * i)) & 0xFF);
+  }
+
+  //! Write End-Of-Elements marker.
+  void EndOfElements()
+  {
+    I32  (16);
+    GUID (THE_EOE_GUID);
+  }
+
+  const std::vector<char>& Data() const { return myData; }
+
+private:
+  void put (const Jt_U64 theValue, const int theSize)
+  {
+    for (int i = 0; i < theSize; i++)
+      myData.push_back (static_cast<char> ((theValue >> (8 * i)) & 0xFF));
+  }
+
+private:
+  std::vector<char> myData;
+};
+
+//=======================================================================
+//function : segment
+//purpose  : Make a segment with the given header and data
+//=======================================================================
+static std::vector<char> segment (const Jt_GUID&           theGUID,
+                                  const Standard_Integer   theType,
+                                  const std::vector<char>& theData,
+                                  const Standard_Boolean   theToCompress)
+{
+  const Standard_Boolean isCompressible = theType == 1 || theType == 4;
+
+  std::vector<char> aData = theData;
+  if (theToCompress)
+  {
+    uLongf aLength = compressBound (static_cast<uLong> (theData.size()));
+    aData.resize (aLength);
+    compress2 (reinterpret_cast<Bytef*> (&aData[0]), &aLength,
+               reinterpret_cast<const Bytef*> (&theData[0]), static_cast<uLong> (theData.size()), 9);
+    aData.resize (aLength);
+  }
+
+  JtTest_Writer aWriter;
+  aWriter.GUID (theGUID);
+  aWriter.I32  (theType);
+  aWriter.I32  (static_cast<Jt_I32> (24 + (isCompressible ? 9 : 0) + aData.size()));
+  if (isCompressible)
+  {
+    aWriter.I32 (theToCompress ? 2 : 1);
+    aWriter.I32 (static_cast<Jt_I32> (aData.size() + 1));
+    aWriter.U8  (theToCompress ? 2 : 0);
+  }
+  aWriter.Bytes (aData);
+  return aWriter.Data();
+}
+
+//=======================================================================
+//function : lsgSegment
+//purpose  : Make LSG segment with a partition, a part referencing
+//           the test segments by late loaded properties
+//=======================================================================
+static std::vector<char> lsgSegment()
+{
+  JtTest_Writer aWriter;
+
+  // partition node with the part node as a child
+  Standard_Size anElem = aWriter.BeginElement (THE_PARTITION_GUID, 1);
+  aWriter.I16 (1); aWriter.U32 (0); aWriter.I32 (0);  // base node: no attributes
+  aWriter.I16 (1); aWriter.I32 (1); aWriter.I32 (THE_PART_ID);  // group node
+  aWriter.I32 (0);                                    // partition flags
+  aWriter.MbString ("");                              // file name
+  for (int i = 0; i < 6; i++) aWriter.F32 (0.0f);     // bounding box
+  aWriter.F32 (0.0f);                                 // area
+  for (int i = 0; i < 6; i++) aWriter.I32 (0);        // vertex, node, polygon ranges
+  aWriter.EndElement (anElem);
+
+  // part node
+  anElem = aWriter.BeginElement (THE_PART_GUID, THE_PART_ID);
+  aWriter.I16 (1); aWriter.U32 (0); aWriter.I32 (0);  // base node
+  aWriter.I16 (1); aWriter.I32 (0);                   // group node: no children
+  aWriter.I16 (1);                                    // meta data node
+  aWriter.I16 (1); aWriter.I32 (0);                   // part node
+  aWriter.EndElement (anElem);
+
+  aWriter.EndOfElements();
+
+  // late loaded properties
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    anElem = aWriter.BeginElement (THE_LATELOAD_GUID, THE_PROPERTY_ID + 1 + aSegIdx);
+    aWriter.I16  (1); aWriter.U32 (0);                // base property
+    aWriter.I16  (1);
+    aWriter.GUID (THE_SEGMENTS[aSegIdx].GUID);
+    aWriter.I32  (THE_SEGMENTS[aSegIdx].Type);
+    aWriter.I32  (0); aWriter.I32 (0);                // payload object ID, reserved
+    aWriter.EndElement (anElem);
+  }
+
+  aWriter.EndOfElements();
+
+  // property table binding the properties to the part
+  aWriter.I16 (1);
+  aWriter.I32 (1);
+  aWriter.I32 (THE_PART_ID);
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    aWriter.I32 (THE_PROPERTY_ID);
+    aWriter.I32 (THE_PROPERTY_ID + 1 + aSegIdx);
+  }
+  aWriter.I32 (0);
+
+  return segment (THE_LSG_GUID, 1, aWriter.Data(), Standard_False);
+}
+
+//=======================================================================
+//function : stringSegment
+//purpose  : Make a late loaded segment containing a string property
+//=======================================================================
+static std::vector<char> stringSegment (const TestSegment& theSegment)
+{
+  JtTest_Writer aWriter;
+
+  const Standard_Size anElem = aWriter.BeginElement (THE_STRING_GUID, 1);
+  aWriter.I16 (1); aWriter.U32 (0);                   // base property
+  aWriter.I16 (1);
+  aWriter.MbString (theSegment.Value);
+  aWriter.EndElement (anElem);
+
+  return segment (theSegment.GUID, theSegment.Type, aWriter.Data(), theSegment.IsCompressed);
+}
+
+//=======================================================================
+//function : writeAt
+//purpose  : Write data at the given 64-bit file offset
+//=======================================================================
+static bool writeAt (FILE* theFile, const Jt_U64 theOffset, const std::vector<char>& theData)
+{
+#ifdef WNT
+  if (_fseeki64 (theFile, static_cast<__int64> (theOffset), SEEK_SET) != 0)
+#else
+  if (fseeko (theFile, static_cast<off_t> (theOffset), SEEK_SET) != 0)
+#endif
+    return false;
+
+  return fwrite (&theData[0], 1, theData.size(), theFile) == theData.size();
+}
+
+//=======================================================================
+//function : writeFile
+//purpose  : Write the sparse test file
+//=======================================================================
+static bool writeFile()
+{
+  FILE* aFile = fopen (THE_FILE_NAME, "wb");
+  if (aFile == NULL)
+    return false;
+
+#ifdef WNT
+  // keep the gaps unallocated on NTFS
+  DWORD aBytes = 0;
+  DeviceIoControl (reinterpret_cast<HANDLE> (_get_osfhandle (_fileno (aFile))),
+                   FSCTL_SET_SPARSE, NULL, 0, NULL, 0, &aBytes, NULL);
+#endif
+
+  // file header
+  JtTest_Writer aHeader;
+  std::vector<char> aVersion (80, ' ');
+  memcpy (&aVersion[0], "Version 10.0 JT", 15);
+  aHeader.Bytes (aVersion);
+  aHeader.U8   (0);
+  aHeader.I32  (0);
+  aHeader.U64  (THE_TOC_OFFSET);
+  aHeader.GUID (THE_LSG_GUID);
+
+  // table of contents
+  const std::vector<char> anLSG = lsgSegment();
+
+  JtTest_Writer aTOC;
+  aTOC.I32  (1 + THE_NB_SEGMENTS);
+  aTOC.GUID (THE_LSG_GUID);
+  aTOC.U64  (THE_LSG_OFFSET);
+  aTOC.I32  (static_cast<Jt_I32> (anLSG.size()));
+  aTOC.U32  (1u << 24);
+
+  bool isWritten = writeAt (aFile, 0, aHeader.Data())
+                && writeAt (aFile, THE_LSG_OFFSET, anLSG);
+
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    const TestSegment&      aSegment = THE_SEGMENTS[aSegIdx];
+    const std::vector<char> aData    = stringSegment (aSegment);
+
+    aTOC.GUID (aSegment.GUID);
+    aTOC.U64  (aSegment.Offset);
+    aTOC.I32  (static_cast<Jt_I32> (aData.size()));
+    aTOC.U32  (static_cast<Jt_U32> (aSegment.Type) << 24);
+
+    isWritten = isWritten && writeAt (aFile, aSegment.Offset, aData);
+  }
+
+  isWritten = isWritten && writeAt (aFile, THE_TOC_OFFSET, aTOC.Data());
+
+  return fclose (aFile) == 0 && isWritten;
+}
+
+//=======================================================================
+//function : checkString
+//purpose  : Check that the object is a string property with the given value
+//=======================================================================
+static void checkString (const Handle(JtData_Object)& theObject,
+                         const TestSegment&           theSegment,
+                         const char*                  theWhat)
+{
+  Handle(JtProperty_String) aString = Handle(JtProperty_String)::DownCast (theObject);
+  check (!aString.IsNull()
+      && aString->Value().IsEqual (TCollection_ExtendedString (theSegment.Value)), theWhat, theSegment.Value);
+}
+
+//=======================================================================
+//function : testModel
+//purpose  : Read the segments of the test file with JtData_Model
+//=======================================================================
+static void testModel()
+{
+  Handle(JtData_Model)     aModel = new JtData_Model (THE_FILE_NAME);
+  Handle(JtNode_Partition) aRoot  = aModel->Init();
+  check (!aRoot.IsNull(), "LSG reading with TOC beyond 4 GB");
+  if (aRoot.IsNull())
+    return;
+
+  // TOC entries
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    Jt_U64 anOffset = 0;
+    check (!aModel->FindSegment (THE_SEGMENTS[aSegIdx].GUID, anOffset).IsNull()
+        && anOffset == THE_SEGMENTS[aSegIdx].Offset, "TOC offset", THE_SEGMENTS[aSegIdx].Value);
+  }
+
+  // direct segment reading
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+    checkString (aModel->ReadSegment (THE_SEGMENTS[aSegIdx].Offset), THE_SEGMENTS[aSegIdx], "ReadSegment");
+
+  // late loaded properties of the part
+  Handle(JtNode_Part) aPart;
+  if (aRoot->Children().Count() == 1)
+    aPart = Handle(JtNode_Part)::DownCast (aRoot->Children()[0]);
+
+  const Standard_Size aNbLateLoads = aPart.IsNull() ? 0 : aPart->LateLoads().Count();
+  check (aNbLateLoads == static_cast<Standard_Size> (THE_NB_SEGMENTS), "late loaded properties binding");
+  if (aNbLateLoads != static_cast<Standard_Size> (THE_NB_SEGMENTS))
+    return;
+
+  JtData_Object::ListOfLateLoads aLateLoads;
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    const Handle(JtProperty_LateLoaded)& aLateLoad = aPart->LateLoads()[aSegIdx];
+    aLateLoad->Load();
+    checkString (aLateLoad->DefferedObject(), THE_SEGMENTS[aSegIdx], "late loading");
+    aLateLoad->Unload();
+
+    aLateLoads.Append (aLateLoad);
+  }
+
+  JtData_Model::LoadSegments (aLateLoads);
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    checkString (aPart->LateLoads()[aSegIdx]->DefferedObject(), THE_SEGMENTS[aSegIdx], "parallel late loading");
+    aPart->LateLoads()[aSegIdx]->Unload();
+  }
+
+  // cached segments are keyed by 64-bit offsets
+  const JtData_SegmentCache::Mode aModes[] = { JtData_SegmentCache::Mode_Objects, JtData_SegmentCache::Mode_RawData };
+  for (int aModeIdx = 0; aModeIdx < 2; ++aModeIdx)
+  {
+    aModel->SetSegmentCache (1 << 20, aModes[aModeIdx]);
+    for (int aPass = 0; aPass < 2; ++aPass)
+    {
+      for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+      {
+        const Handle(JtProperty_LateLoaded)& aLateLoad = aPart->LateLoads()[aSegIdx];
+        aLateLoad->Load();
+        checkString (aLateLoad->DefferedObject(), THE_SEGMENTS[aSegIdx], "cached late loading");
+        aLateLoad->Unload();
+      }
+    }
+    check (aModel->SegmentCacheStatistics().Hits >= static_cast<Standard_Size> (THE_NB_SEGMENTS), "segment cache hits");
+    aModel->SetSegmentCache (0);
+  }
+}
+
+//=======================================================================
+//function : testPooledReader
+//purpose  : Read the segment headers with the positional file reader
+//=======================================================================
+static void testPooledReader()
+{
+  // the model provides the byte order of the file
+  Handle(JtData_Model) aModel = new JtData_Model (THE_FILE_NAME);
+  check (!aModel->Init().IsNull(), "LSG reading with TOC beyond 4 GB");
+
+  JtData_SharedFile aFile;
+  check (aFile.Open (THE_FILE_NAME) == Standard_True, "shared file opening");
+  if (!aFile.IsOpen())
+    return;
+
+  for (Standard_Integer aSegIdx = 0; aSegIdx < THE_NB_SEGMENTS; ++aSegIdx)
+  {
+    JtData_PooledReader aReader (aFile, aModel, THE_SEGMENTS[aSegIdx].Offset);
+    Jt_GUID aGUID;
+    Jt_I32  aType = 0;
+    check (aReader.ReadGUID (aGUID) && aReader.ReadI32 (aType)
+        && aGUID == THE_SEGMENTS[aSegIdx].GUID && aType == THE_SEGMENTS[aSegIdx].Type,
+           "positional reading", THE_SEGMENTS[aSegIdx].Value);
+  }
+}
+
+//=======================================================================
+//function : main
+//purpose  :
+//=======================================================================
+int main()
+{
+  if (!writeFile())
+  {
+    std::cerr << "FAILED: writing of the sparse test file " << THE_FILE_NAME << std::endl;
+    remove (THE_FILE_NAME);
+    return 1;
+  }
+
+  testModel();
+  testPooledReader();
+
+  remove (THE_FILE_NAME);
+
+  if (THE_NB_FAILURES != 0)
+  {
+    std::cerr << THE_NB_FAILURES << " check(s) failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,176 @@
+// JT format reading and visualization tools
+// Copyright (C) 2014-2015 OPEN CASCADE SAS
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 of the License, or any later
+// version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// Copy of the GNU General Public License is in LICENSE.txt and
+// on <http://www.gnu.org/licenses/>.
+
+// Test of bit-exactness of the vectorized (SSE2, AVX2) unpackers
+// against the scalar ones on random residuals of lengths 0 to 64
+// and of a large length. Instruction sets not supported by the CPU
+// (or the compiler) are reported as skipped.
+
+#include <JtDecode_Unpack.hxx>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  //! Unpacker under test.
+  struct TestUnpacker
+  {
+    JtDecode_Unpack* Function;
+    const char*      Name;
+  };
+
+  const TestUnpacker THE_UNPACKERS[] =
+  {
+    { JtDecode_Unpack_Lag1,     "Lag1"     },
+    { JtDecode_Unpack_Lag2,     "Lag2"     },
+    { JtDecode_Unpack_Xor1,     "Xor1"     },
+    { JtDecode_Unpack_Xor2,     "Xor2"     },
+    { JtDecode_Unpack_Stride1,  "Stride1"  },
+    { JtDecode_Unpack_Stride2,  "Stride2"  },
+    { JtDecode_Unpack_Ramp,     "Ramp"     },
+    { JtDecode_Unpack_StripIdx, "StripIdx" }
+  };
+
+  const int THE_NB_UNPACKERS = sizeof (THE_UNPACKERS) / sizeof (THE_UNPACKERS[0]);
+
+  //! Vectorized instruction sets under test.
+  struct TestLevel
+  {
+    JtDecode_UnpackLevel Level;
+    const char*          Name;
+  };
+
+  const TestLevel THE_LEVELS[] =
+  {
+    { JtDecode_UnpackLevel_SSE2, "SSE2" },
+    { JtDecode_UnpackLevel_AVX2, "AVX2" }
+  };
+
+  const int THE_MAX_SMALL_LENGTH = 64;
+  const int THE_LARGE_LENGTH     = 100003;
+  const int THE_NB_RUNS          = 16;
+
+  //! Linear congruential generator, the same sequence on all platforms.
+  class Random
+  {
+  public:
+    Random() : myState (12345u) {}
+
+    uint32_t Next()
+    {
+      myState = myState * 1664525u + 1013904223u;
+      return myState;
+    }
+
+    //! Random residual: full range, small or zero values.
+    int32_t Residual()
+    {
+      const uint32_t aValue = Next();
+      switch (Next() >> 30)
+      {
+        case 0:  return static_cast<int32_t> (aValue);
+        case 1:  return static_cast<int32_t> (aValue % 17) - 8;
+        case 2:  return 0;
+        default: return static_cast<int32_t> (aValue % 65536) - 32768;
+      }
+    }
+
+  private:
+    uint32_t myState;
+  };
+}
+
+//=======================================================================
+//function : unpack
+//purpose  : Unpack a copy of the residuals with the given instruction set
+//=======================================================================
+static std::vector<int32_t> unpack (const TestUnpacker&         theUnpacker,
+                                    const JtDecode_UnpackLevel  theLevel,
+                                    const std::vector<int32_t>& theResiduals)
+{
+  JtDecode_Unpack_SetLevel (theLevel);
+
+  // pad the copy to catch writes beyond the values
+  std::vector<int32_t> aValues (theResiduals);
+  aValues.push_back (0x7e57);
+
+  int32_t* aData = aValues.empty() ? NULL : &aValues[0];
+  theUnpacker.Function (JtData_VectorRef<int32_t, int32_t> (aData, static_cast<int32_t> (theResiduals.size())));
+  return aValues;
+}
+
+//=======================================================================
+//function : main
+//purpose  :
+//=======================================================================
+int main()
+{
+  int aNbFailures = 0;
+  int aNbChecks   = 0;
+
+  for (int aLevelIdx = 0; aLevelIdx < 2; ++aLevelIdx)
+  {
+    const TestLevel& aLevel = THE_LEVELS[aLevelIdx];
+    if (JtDecode_Unpack_SetLevel (aLevel.Level) != aLevel.Level)
+    {
+      std::cout << aLevel.Name << " is not supported, skipped" << std::endl;
+      continue;
+    }
+
+    for (int anUnpackerIdx = 0; anUnpackerIdx < THE_NB_UNPACKERS; ++anUnpackerIdx)
+    {
+      const TestUnpacker& anUnpacker = THE_UNPACKERS[anUnpackerIdx];
+
+      Random aRandom;
+      for (int aLength = 0; aLength <= THE_MAX_SMALL_LENGTH + 1; ++aLength)
+      {
+        const int aCount  = aLength <= THE_MAX_SMALL_LENGTH ? aLength : THE_LARGE_LENGTH;
+        const int aNbRuns = aLength <= THE_MAX_SMALL_LENGTH ? THE_NB_RUNS : 1;
+        for (int aRun = 0; aRun < aNbRuns; ++aRun)
+        {
+          std::vector<int32_t> aResiduals (aCount);
+          for (int i = 0; i < aCount; ++i)
+            aResiduals[i] = aRandom.Residual();
+
+          const std::vector<int32_t> aScalar = unpack (anUnpacker, JtDecode_UnpackLevel_Scalar, aResiduals);
+          const std::vector<int32_t> aVector = unpack (anUnpacker, aLevel.Level,                aResiduals);
+
+          ++aNbChecks;
+          if (aScalar != aVector)
+          {
+            std::cerr << "FAILED: " << anUnpacker.Name << " " << aLevel.Name
+                      << " differs from scalar unpacker, length " << aCount << std::endl;
+            ++aNbFailures;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  JtDecode_Unpack_SetLevel (JtDecode_UnpackLevel_AVX2);
+
+  if (aNbFailures != 0)
+  {
+    std::cerr << aNbFailures << " of " << aNbChecks << " check(s) failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "OK, " << aNbChecks << " checks" << std::endl;
+  return 0;
+}